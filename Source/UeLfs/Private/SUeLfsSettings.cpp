@@ -8,6 +8,7 @@
 #include "Widgets/SBoxPanel.h"
 #include "Widgets/Text/STextBlock.h"
 #include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SCheckBox.h"
 #include "EditorStyleSet.h"
 #include "UeLfsModule.h"
 
@@ -68,6 +69,46 @@ void SUeLfsSettings::Construct(const FArguments& InArgs)
 					.ToolTipText(LOCTEXT("RepoRootPathLabel_Tooltip", "Repository root path."))
 					.Font(Font)
 				]
+				+SVerticalBox::Slot()
+				.FillHeight(1.0f)
+				.Padding(2.0f)
+				.VAlign(VAlign_Center)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("PushRemoteLabel", "Push Remote"))
+					.ToolTipText(LOCTEXT("PushRemoteLabel_Tooltip", "Remote to push to after check-in. Leave empty to commit locally only."))
+					.Font(Font)
+				]
+				+SVerticalBox::Slot()
+				.FillHeight(1.0f)
+				.Padding(2.0f)
+				.VAlign(VAlign_Center)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("PullRemoteLabel", "Pull Remote"))
+					.ToolTipText(LOCTEXT("PullRemoteLabel_Tooltip", "Remote to pull from on sync if the branch has no upstream. The upstream is always preferred."))
+					.Font(Font)
+				]
+				+SVerticalBox::Slot()
+				.FillHeight(1.0f)
+				.Padding(2.0f)
+				.VAlign(VAlign_Center)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("PrimeLockTableLabel", "Load All Locks"))
+					.ToolTipText(LOCTEXT("PrimeLockTableLabel_Tooltip", "Load the lock table of the whole branch when connecting. Needs a server with /getAllLocks."))
+					.Font(Font)
+				]
+				+SVerticalBox::Slot()
+				.FillHeight(1.0f)
+				.Padding(2.0f)
+				.VAlign(VAlign_Center)
+				[
+					SNew(STextBlock)
+					.Text(LOCTEXT("PrefetchDependenciesLabel", "Prefetch Dependencies"))
+					.ToolTipText(LOCTEXT("PrefetchDependenciesLabel_Tooltip", "Fetch the lock states of an asset's hard dependencies when it is opened."))
+					.Font(Font)
+				]
 			]
 			+SHorizontalBox::Slot()
 			.FillWidth(2.0f)
@@ -81,7 +122,6 @@ void SUeLfsSettings::Construct(const FArguments& InArgs)
 					.Text(this, &SUeLfsSettings::GetServerUrlText)
 					.ToolTipText(LOCTEXT("ServerUrlLabel_Tooltip", "Address of UeLfs server."))
 					.OnTextCommitted(this, &SUeLfsSettings::OnServerUrlTextCommited)
-					.OnTextChanged(this, &SUeLfsSettings::OnServerUrlTextCommited, ETextCommit::Default)
 					.Font(Font)
 				]
 				+SVerticalBox::Slot()
@@ -92,7 +132,6 @@ void SUeLfsSettings::Construct(const FArguments& InArgs)
 					.Text(this, &SUeLfsSettings::GetUserNameText)
 					.ToolTipText(LOCTEXT("UserNameLabel_Tooltip", "UeLfs username"))
 					.OnTextCommitted(this, &SUeLfsSettings::OnUserNameTextCommited)
-					.OnTextChanged(this, &SUeLfsSettings::OnUserNameTextCommited, ETextCommit::Default)
 					.Font(Font)
 				]
 				+SVerticalBox::Slot()
@@ -112,9 +151,46 @@ void SUeLfsSettings::Construct(const FArguments& InArgs)
 					.Text(this, &SUeLfsSettings::GetRepoRootPathText)
 					.ToolTipText(LOCTEXT("RepoRootPathLabel_Tooltip", "Repository root path."))
 					.OnTextCommitted(this, &SUeLfsSettings::OnRepoRootPathTextCommited)
-					.OnTextChanged(this, &SUeLfsSettings::OnRepoRootPathTextCommited, ETextCommit::Default)
 					.Font(Font)
 				]
+				+SVerticalBox::Slot()
+				.FillHeight(1.0f)
+				.Padding(2.0f)
+				[
+					SNew(SEditableTextBox)
+					.Text(this, &SUeLfsSettings::GetPushRemoteText)
+					.ToolTipText(LOCTEXT("PushRemoteLabel_Tooltip", "Remote to push to after check-in. Leave empty to commit locally only."))
+					.OnTextCommitted(this, &SUeLfsSettings::OnPushRemoteTextCommited)
+					.Font(Font)
+				]
+				+SVerticalBox::Slot()
+				.FillHeight(1.0f)
+				.Padding(2.0f)
+				[
+					SNew(SEditableTextBox)
+					.Text(this, &SUeLfsSettings::GetPullRemoteText)
+					.ToolTipText(LOCTEXT("PullRemoteLabel_Tooltip", "Remote to pull from on sync if the branch has no upstream. The upstream is always preferred."))
+					.OnTextCommitted(this, &SUeLfsSettings::OnPullRemoteTextCommited)
+					.Font(Font)
+				]
+				+SVerticalBox::Slot()
+				.FillHeight(1.0f)
+				.Padding(2.0f)
+				[
+					SNew(SCheckBox)
+					.IsChecked(this, &SUeLfsSettings::IsPrimeLockTableChecked)
+					.ToolTipText(LOCTEXT("PrimeLockTableLabel_Tooltip", "Load the lock table of the whole branch when connecting. Needs a server with /getAllLocks."))
+					.OnCheckStateChanged(this, &SUeLfsSettings::OnPrimeLockTableChanged)
+				]
+				+SVerticalBox::Slot()
+				.FillHeight(1.0f)
+				.Padding(2.0f)
+				[
+					SNew(SCheckBox)
+					.IsChecked(this, &SUeLfsSettings::IsPrefetchDependenciesChecked)
+					.ToolTipText(LOCTEXT("PrefetchDependenciesLabel_Tooltip", "Fetch the lock states of an asset's hard dependencies when it is opened."))
+					.OnCheckStateChanged(this, &SUeLfsSettings::OnPrefetchDependenciesChanged)
+				]
 				//+ SVerticalBox::Slot()
 				//.FillHeight(2.0f)
 				//.Padding(2.0f)
@@ -141,7 +217,7 @@ void SUeLfsSettings::OnServerUrlTextCommited(const FText& InText, ETextCommit::T
 {
 	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>("UeLfs");
 	UeLfs.AccessSettings().SetServerUrl(InText.ToString());
-	UeLfs.SaveSettings();
+	UeLfs.RequestSaveSettings();
 }
 
 FText SUeLfsSettings::GetUserNameText() const
@@ -154,14 +230,14 @@ void SUeLfsSettings::OnUserNameTextCommited(const FText& InText, ETextCommit::Ty
 {
 	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>("UeLfs");
 	UeLfs.AccessSettings().SetUserName(InText.ToString());
-	UeLfs.SaveSettings();
+	UeLfs.RequestSaveSettings();
 }
 
 void SUeLfsSettings::OnRepoRootPathTextCommited(const FText& InText, ETextCommit::Type InCommitType) const
 {
 	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>("UeLfs");
 	UeLfs.AccessSettings().SetRepoRootPath(InText.ToString());
-	UeLfs.SaveSettings();
+	UeLfs.RequestSaveSettings();
 }
 
 FText SUeLfsSettings::GetGitBinaryPathText() const
@@ -176,4 +252,56 @@ FText SUeLfsSettings::GetRepoRootPathText() const
 	return FText::FromString(UeLfs.AccessSettings().GetRepoRootPath());
 }
 
+FText SUeLfsSettings::GetPushRemoteText() const
+{
+	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>("UeLfs");
+	return FText::FromString(UeLfs.AccessSettings().GetPushRemote());
+}
+
+void SUeLfsSettings::OnPushRemoteTextCommited(const FText& InText, ETextCommit::Type InCommitType) const
+{
+	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>("UeLfs");
+	UeLfs.AccessSettings().SetPushRemote(InText.ToString());
+	UeLfs.RequestSaveSettings();
+}
+
+FText SUeLfsSettings::GetPullRemoteText() const
+{
+	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>("UeLfs");
+	return FText::FromString(UeLfs.AccessSettings().GetPullRemote());
+}
+
+void SUeLfsSettings::OnPullRemoteTextCommited(const FText& InText, ETextCommit::Type InCommitType) const
+{
+	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>("UeLfs");
+	UeLfs.AccessSettings().SetPullRemote(InText.ToString());
+	UeLfs.RequestSaveSettings();
+}
+
+ECheckBoxState SUeLfsSettings::IsPrimeLockTableChecked() const
+{
+	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>("UeLfs");
+	return UeLfs.AccessSettings().GetPrimeLockTable() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+}
+
+void SUeLfsSettings::OnPrimeLockTableChanged(ECheckBoxState InState) const
+{
+	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>("UeLfs");
+	UeLfs.AccessSettings().SetPrimeLockTable(InState == ECheckBoxState::Checked);
+	UeLfs.RequestSaveSettings();
+}
+
+ECheckBoxState SUeLfsSettings::IsPrefetchDependenciesChecked() const
+{
+	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>("UeLfs");
+	return UeLfs.AccessSettings().GetPrefetchDependencies() ? ECheckBoxState::Checked : ECheckBoxState::Unchecked;
+}
+
+void SUeLfsSettings::OnPrefetchDependenciesChanged(ECheckBoxState InState) const
+{
+	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>("UeLfs");
+	UeLfs.AccessSettings().SetPrefetchDependencies(InState == ECheckBoxState::Checked);
+	UeLfs.RequestSaveSettings();
+}
+
 #undef LOCTEXT_NAMESPACE // "SUeLfsSettings"
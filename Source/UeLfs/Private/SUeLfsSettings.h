@@ -32,6 +32,18 @@ public:
 	FText GetRepoRootPathText() const;
 	void OnRepoRootPathTextCommited(const FText& InText, ETextCommit::Type InCommitType) const;
 
+	FText GetPushRemoteText() const;
+	void OnPushRemoteTextCommited(const FText& InText, ETextCommit::Type InCommitType) const;
+
+	FText GetPullRemoteText() const;
+	void OnPullRemoteTextCommited(const FText& InText, ETextCommit::Type InCommitType) const;
+
+	ECheckBoxState IsPrimeLockTableChecked() const;
+	void OnPrimeLockTableChanged(ECheckBoxState InState) const;
+
+	ECheckBoxState IsPrefetchDependenciesChecked() const;
+	void OnPrefetchDependenciesChanged(ECheckBoxState InState) const;
+
 private:
 
 	mutable FCriticalSection CriticalSection;
@@ -0,0 +1,228 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#include "SUeLfsUnlockDialog.h"
+#include "Misc/PackageName.h"
+#include "Widgets/SBoxPanel.h"
+#include "Widgets/Layout/SBorder.h"
+#include "Widgets/Text/STextBlock.h"
+#include "Widgets/Input/SButton.h"
+#include "Widgets/Input/SSearchBox.h"
+#include "Widgets/Views/STableRow.h"
+#include "EditorStyleSet.h"
+
+#define LOCTEXT_NAMESPACE "SUeLfsUnlockDialog"
+
+void SUeLfsUnlockDialog::Construct(const FArguments& InArgs)
+{
+	ParentWindow = InArgs._ParentWindow;
+
+	for (const FLfsLockItem& Item : InArgs._LockedItems)
+	{
+		AllItems.Add(MakeShared<FLfsLockItem>(Item));
+	}
+
+	AllItems.Sort([](const FLockItemPtr& A, const FLockItemPtr& B)
+	{
+		return A->GitFilePath < B->GitFilePath;
+	});
+
+	FilteredItems = AllItems;
+
+	ChildSlot
+	[
+		SNew(SBorder)
+		.BorderImage(FEditorStyle::GetBrush("ToolPanel.GroupBorder"))
+		.Padding(4.0f)
+		[
+			SNew(SVerticalBox)
+			+SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(2.0f)
+			[
+				SNew(STextBlock)
+				.Text(LOCTEXT("UnlockMessage", "Select content to unlock."))
+			]
+			+SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(2.0f)
+			[
+				SNew(SSearchBox)
+				.HintText(LOCTEXT("FilterHint", "Filter by path"))
+				.OnTextChanged(this, &SUeLfsUnlockDialog::OnFilterTextChanged)
+			]
+			+SVerticalBox::Slot()
+			.FillHeight(1.0f)
+			.Padding(2.0f)
+			[
+				SAssignNew(ListView, SListView<FLockItemPtr>)
+				.ListItemsSource(&FilteredItems)
+				.SelectionMode(ESelectionMode::Multi)
+				.OnGenerateRow(this, &SUeLfsUnlockDialog::OnGenerateRow)
+			]
+			+SVerticalBox::Slot()
+			.AutoHeight()
+			.Padding(2.0f)
+			[
+				SNew(SHorizontalBox)
+				+SHorizontalBox::Slot()
+				.FillWidth(1.0f)
+				.VAlign(VAlign_Center)
+				[
+					SNew(STextBlock)
+					.Text(this, &SUeLfsUnlockDialog::GetSummaryText)
+				]
+				+SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(2.0f)
+				[
+					SNew(SButton)
+					.Text(LOCTEXT("SelectAllButton", "Select All"))
+					.ToolTipText(LOCTEXT("SelectAllButton_Tooltip", "Select every item matching the filter"))
+					.OnClicked(this, &SUeLfsUnlockDialog::OnSelectAllClicked)
+				]
+				+SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(2.0f)
+				[
+					SNew(SButton)
+					.Text(LOCTEXT("UnlockSelectedButton", "Unlock Selected"))
+					.ToolTipText(LOCTEXT("UnlockSelectedButton_Tooltip", "Attempt to unlock the selected content"))
+					.IsEnabled(this, &SUeLfsUnlockDialog::IsUnlockEnabled)
+					.OnClicked(this, &SUeLfsUnlockDialog::OnUnlockClicked)
+				]
+				+SHorizontalBox::Slot()
+				.AutoWidth()
+				.Padding(2.0f)
+				[
+					SNew(SButton)
+					.Text(LOCTEXT("CancelButton", "Cancel"))
+					.ToolTipText(LOCTEXT("CancelButton_Tooltip", "Do not unlock any content"))
+					.OnClicked(this, &SUeLfsUnlockDialog::OnCancelClicked)
+				]
+			]
+		]
+	];
+}
+
+TSharedRef<ITableRow> SUeLfsUnlockDialog::OnGenerateRow(FLockItemPtr Item,
+	const TSharedRef<STableViewBase>& OwnerTable)
+{
+	// Package names are derived from the path only; nothing gets loaded.
+	FString PackageName;
+	if (!FPackageName::TryConvertFilenameToLongPackageName(Item->LocalFilePath, PackageName))
+	{
+		PackageName = FPaths::GetBaseFilename(Item->LocalFilePath);
+	}
+
+	return SNew(STableRow<FLockItemPtr>, OwnerTable)
+	[
+		SNew(SHorizontalBox)
+		+SHorizontalBox::Slot()
+		.FillWidth(1.0f)
+		.Padding(2.0f)
+		[
+			SNew(STextBlock)
+			.Text(FText::FromString(PackageName))
+			.HighlightText(this, &SUeLfsUnlockDialog::GetFilterText)
+		]
+		+SHorizontalBox::Slot()
+		.FillWidth(1.0f)
+		.Padding(2.0f)
+		[
+			SNew(STextBlock)
+			.Text(FText::FromString(Item->GitFilePath))
+			.HighlightText(this, &SUeLfsUnlockDialog::GetFilterText)
+			.ColorAndOpacity(FSlateColor::UseSubduedForeground())
+		]
+	];
+}
+
+void SUeLfsUnlockDialog::OnFilterTextChanged(const FText& InText)
+{
+	FilterString = InText.ToString();
+	ApplyFilter();
+}
+
+FText SUeLfsUnlockDialog::GetFilterText() const
+{
+	return FText::FromString(FilterString);
+}
+
+FText SUeLfsUnlockDialog::GetSummaryText() const
+{
+	return FText::Format(LOCTEXT("Summary", "{0} of {1} selected"),
+		FText::AsNumber(ListView.IsValid() ? ListView->GetNumItemsSelected() : 0),
+		FText::AsNumber(AllItems.Num()));
+}
+
+bool SUeLfsUnlockDialog::IsUnlockEnabled() const
+{
+	return ListView.IsValid() && ListView->GetNumItemsSelected() > 0;
+}
+
+FReply SUeLfsUnlockDialog::OnSelectAllClicked()
+{
+	for (const FLockItemPtr& Item : FilteredItems)
+	{
+		ListView->SetItemSelection(Item, true);
+	}
+	return FReply::Handled();
+}
+
+FReply SUeLfsUnlockDialog::OnUnlockClicked()
+{
+	for (const FLockItemPtr& Item : ListView->GetSelectedItems())
+	{
+		ItemsToUnlock.Add(*Item);
+	}
+
+	CloseWindow();
+	return FReply::Handled();
+}
+
+FReply SUeLfsUnlockDialog::OnCancelClicked()
+{
+	ItemsToUnlock.Empty();
+
+	CloseWindow();
+	return FReply::Handled();
+}
+
+void SUeLfsUnlockDialog::ApplyFilter()
+{
+	FilteredItems.Reset();
+	TSet<FLockItemPtr> VisibleItems;
+	for (const FLockItemPtr& Item : AllItems)
+	{
+		if (FilterString.IsEmpty() || Item->GitFilePath.Contains(FilterString))
+		{
+			FilteredItems.Add(Item);
+			VisibleItems.Add(Item);
+		}
+	}
+
+	// Hidden rows must not be unlocked behind the user's back.
+	TArray<FLockItemPtr> Selected = ListView->GetSelectedItems();
+	for (const FLockItemPtr& Item : Selected)
+	{
+		if (!VisibleItems.Contains(Item))
+		{
+			ListView->SetItemSelection(Item, false);
+		}
+	}
+
+	ListView->RequestListRefresh();
+}
+
+void SUeLfsUnlockDialog::CloseWindow()
+{
+	TSharedPtr<SWindow> Window = ParentWindow.Pin();
+	if (Window.IsValid())
+	{
+		Window->RequestDestroyWindow();
+	}
+}
+
+#undef LOCTEXT_NAMESPACE // "SUeLfsUnlockDialog"
@@ -0,0 +1,67 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Widgets/DeclarativeSyntaxSupport.h"
+#include "Widgets/SCompoundWidget.h"
+#include "Widgets/SWindow.h"
+#include "Widgets/Views/SListView.h"
+#include "UeLfsUtils.h"
+
+/**
+ * Lists locked files straight from the provider's lock states, without loading any packages.
+ * Rows are virtualized, so hundreds of locks cost no more than a screenful.
+ */
+class SUeLfsUnlockDialog : public SCompoundWidget
+{
+public:
+
+	SLATE_BEGIN_ARGS(SUeLfsUnlockDialog) {}
+
+		SLATE_ARGUMENT(TArray<FLfsLockItem>, LockedItems)
+
+		SLATE_ARGUMENT(TWeakPtr<SWindow>, ParentWindow)
+
+	SLATE_END_ARGS()
+
+public:
+
+	void Construct(const FArguments& InArgs);
+
+	// Items the user chose to unlock. (empty if cancelled)
+	const TArray<FLfsLockItem>& GetItemsToUnlock() const { return ItemsToUnlock; }
+
+private:
+	typedef TSharedPtr<FLfsLockItem> FLockItemPtr;
+
+	TSharedRef<ITableRow> OnGenerateRow(FLockItemPtr Item, const TSharedRef<STableViewBase>& OwnerTable);
+
+	void OnFilterTextChanged(const FText& InText);
+	FText GetFilterText() const;
+	FText GetSummaryText() const;
+
+	bool IsUnlockEnabled() const;
+	FReply OnSelectAllClicked();
+	FReply OnUnlockClicked();
+	FReply OnCancelClicked();
+
+	// Rebuild the visible rows from the filter.
+	void ApplyFilter();
+
+	void CloseWindow();
+
+private:
+
+	TArray<FLockItemPtr> AllItems;
+	TArray<FLockItemPtr> FilteredItems;
+	TSharedPtr<SListView<FLockItemPtr>> ListView;
+
+	FString FilterString;
+
+	TArray<FLfsLockItem> ItemsToUnlock;
+
+	TWeakPtr<SWindow> ParentWindow;
+};
@@ -0,0 +1,240 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#include "UeLfsBlobCache.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "ISourceControlModule.h"
+#include "UeLfsUtils.h"
+#include "UeLfsTrace.h"
+
+namespace UeLfsBlobCacheConstants
+{
+	/** Size cap of the blob cache in bytes */
+	static const int64 MaxCacheSize = 1024ll * 1024ll * 1024ll;
+
+	/** Length of a full (SHA-1) commit hash */
+	static const int32 CommitHashLen = 40;
+}
+
+FUeLfsBlobCache::FUeLfsBlobCache()
+	: CacheDir(FPaths::ProjectSavedDir() / TEXT("UeLfs") / TEXT("Blobs"))
+	, TotalSize(0)
+	, bIndexLoaded(false)
+{
+}
+
+bool FUeLfsBlobCache::Export(const FString& RepoRootPath, const FString& Revision,
+	const FString& GitFilePath, const FString& DestFilename)
+{
+	UELFS_TRACE_SCOPE(UeLfs_BlobExport);
+
+	// Only full commit hashes are immutable; anything else (e.g. "HEAD") is resolved every time.
+	const bool bImmutable = Revision.Len() == UeLfsBlobCacheConstants::CommitHashLen;
+	const FString RevisionKey = Revision + TEXT(":") + GitFilePath;
+
+	FString Oid;
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		LoadIndex();
+
+		const FString* KnownOid = bImmutable ? BlobOids.Find(RevisionKey) : nullptr;
+		if (KnownOid != nullptr)
+		{
+			Oid = *KnownOid;
+		}
+	}
+
+	if (Oid.IsEmpty())
+	{
+		if (!ResolveBlobOid(RepoRootPath, Revision, GitFilePath, Oid))
+		{
+			return false;
+		}
+
+		if (bImmutable)
+		{
+			FScopeLock ScopeLock(&CriticalSection);
+			BlobOids.Add(RevisionKey, Oid);
+		}
+	}
+
+	// Pin the blob so other threads can't evict it while it is copied out.
+	bool bCached = false;
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		FBlob* Blob = Blobs.Find(Oid);
+		if (Blob != nullptr)
+		{
+			++Blob->PinCount;
+			bCached = true;
+		}
+	}
+
+	if (!bCached && !FetchBlob(RepoRootPath, Revision, GitFilePath, Oid))
+	{
+		return false;
+	}
+
+	const FString BlobPath = GetBlobPath(Oid);
+	const bool bCopied = IFileManager::Get().Copy(*DestFilename, *BlobPath) == COPY_OK;
+
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		FBlob& Blob = Blobs.FindChecked(Oid);
+		--Blob.PinCount;
+
+		if (bCopied)
+		{
+			// The file time stamp carries the access time over to later sessions.
+			Blob.LastAccess = FDateTime::UtcNow();
+			IFileManager::Get().SetTimeStamp(*BlobPath, Blob.LastAccess);
+		}
+	}
+
+	if (!bCopied)
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to copy cached blob %s to %s!"), *Oid, *DestFilename);
+		return false;
+	}
+
+	return true;
+}
+
+bool FUeLfsBlobCache::ResolveBlobOid(const FString& RepoRootPath, const FString& Revision,
+	const FString& GitFilePath, FString& OutOid)
+{
+	FString ArgStr = FString::Printf(TEXT("-C %s rev-parse \"%s:%s\""),
+		*RepoRootPath,
+		*Revision,
+		*GitFilePath);
+
+	int32 ReturnCode;
+	FString StdOut;
+	FString StdErr;
+	if (!UeLfsUtils::RunGitCommand(ArgStr, ReturnCode, StdOut, StdErr))
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to resolve %s:%s! - %s"), *Revision, *GitFilePath, *StdErr);
+		return false;
+	}
+
+	OutOid = StdOut.TrimStartAndEnd();
+	return !OutOid.IsEmpty();
+}
+
+bool FUeLfsBlobCache::FetchBlob(const FString& RepoRootPath, const FString& Revision,
+	const FString& GitFilePath, const FString& Oid)
+{
+	UELFS_TRACE_SCOPE(UeLfs_BlobFetch);
+
+	// --filters runs the smudge filter, so LFS pointers come out as the real content.
+	FString ArgStr = FString::Printf(TEXT("-C %s cat-file --filters \"%s:%s\""),
+		*RepoRootPath,
+		*Revision,
+		*GitFilePath);
+
+	// Stream into a file next to the final name and move it in place, so readers never see partial blobs.
+	const FString BlobPath = GetBlobPath(Oid);
+	const FString TempPath = BlobPath + FString::Printf(TEXT(".%u.tmp"), FPlatformTLS::GetCurrentThreadId());
+
+	int32 ReturnCode;
+	if (!UeLfsUtils::RunGitCommandToFile(ArgStr, TempPath, ReturnCode))
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to export %s:%s!"), *Revision, *GitFilePath);
+		return false;
+	}
+
+	const int64 Size = IFileManager::Get().FileSize(*TempPath);
+	if (!IFileManager::Get().Move(*BlobPath, *TempPath, true, true))
+	{
+		IFileManager::Get().Delete(*TempPath);
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to write cached blob %s!"), *BlobPath);
+		return false;
+	}
+
+	FScopeLock ScopeLock(&CriticalSection);
+
+	// Another thread may have fetched the same blob meanwhile.
+	FBlob* Blob = Blobs.Find(Oid);
+	if (Blob == nullptr)
+	{
+		Blob = &Blobs.Add(Oid);
+		Blob->Size = Size;
+		TotalSize += Blob->Size;
+	}
+
+	// Pinned for the caller, who copies it out.
+	Blob->LastAccess = FDateTime::UtcNow();
+	++Blob->PinCount;
+
+	Evict();
+
+	return true;
+}
+
+void FUeLfsBlobCache::LoadIndex()
+{
+	if (bIndexLoaded)
+	{
+		return;
+	}
+
+	bIndexLoaded = true;
+
+	IFileManager::Get().MakeDirectory(*CacheDir, true);
+	IFileManager::Get().IterateDirectoryStat(*CacheDir,
+		[this](const TCHAR* FilenameOrDirectory, const FFileStatData& StatData)
+		{
+			const FString Filename(FilenameOrDirectory);
+			if (StatData.bIsDirectory)
+			{
+				return true;
+			}
+
+			// Leftovers of interrupted writes.
+			if (Filename.EndsWith(TEXT(".tmp")))
+			{
+				IFileManager::Get().Delete(FilenameOrDirectory);
+				return true;
+			}
+
+			FBlob& Blob = Blobs.Add(FPaths::GetCleanFilename(Filename));
+			Blob.Size = StatData.FileSize;
+			Blob.LastAccess = StatData.ModificationTime;
+			TotalSize += Blob.Size;
+			return true;
+		});
+
+	Evict();
+}
+
+void FUeLfsBlobCache::Evict()
+{
+	if (TotalSize <= UeLfsBlobCacheConstants::MaxCacheSize)
+	{
+		return;
+	}
+
+	Blobs.ValueSort([](const FBlob& A, const FBlob& B)
+	{
+		return A.LastAccess < B.LastAccess;
+	});
+
+	// Always keep the newest blob, even if it exceeds the cap on its own. Blobs being copied out stay.
+	for (auto It = Blobs.CreateIterator(); It && Blobs.Num() > 1 && TotalSize > UeLfsBlobCacheConstants::MaxCacheSize; ++It)
+	{
+		if (It.Value().PinCount == 0 && IFileManager::Get().Delete(*GetBlobPath(It.Key())))
+		{
+			TotalSize -= It.Value().Size;
+			It.RemoveCurrent();
+		}
+	}
+}
+
+FString FUeLfsBlobCache::GetBlobPath(const FString& Oid) const
+{
+	return CacheDir / Oid;
+}
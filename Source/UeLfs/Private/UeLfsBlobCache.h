@@ -0,0 +1,69 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * On-disk cache of file contents exported from git, keyed by blob oid.
+ * The least recently used blobs are evicted once the cache grows past its size cap.
+ * Used from any thread, so all access is guarded.
+ */
+class FUeLfsBlobCache
+{
+public:
+	FUeLfsBlobCache();
+
+	/**
+	 * Export the content of a file at a revision (with LFS pointers resolved).
+	 * Served from the cache without running git if the revision was exported before.
+	 */
+	bool Export(const FString& RepoRootPath, const FString& Revision, const FString& GitFilePath,
+		const FString& DestFilename);
+
+private:
+	// Resolve the blob oid of a file at a revision.
+	bool ResolveBlobOid(const FString& RepoRootPath, const FString& Revision, const FString& GitFilePath,
+		FString& OutOid);
+
+	// Write the smudged content of a blob into the cache, pinned for the caller.
+	bool FetchBlob(const FString& RepoRootPath, const FString& Revision, const FString& GitFilePath,
+		const FString& Oid);
+
+	// Pick up blobs cached by earlier sessions.
+	void LoadIndex();
+
+	// Drop least recently used blobs until the cache fits its size cap.
+	void Evict();
+
+	FString GetBlobPath(const FString& Oid) const;
+
+private:
+	struct FBlob
+	{
+		int64 Size = 0;
+		FDateTime LastAccess;
+
+		/** Number of exports copying the blob out right now; pinned blobs are not evicted */
+		int32 PinCount = 0;
+	};
+
+	/** A critical section for cache access */
+	mutable FCriticalSection CriticalSection;
+
+	/** Directory the blobs are stored in */
+	FString CacheDir;
+
+	/** Cached blobs by oid */
+	TMap<FString, FBlob> Blobs;
+
+	/** Blob oids by "<commit>:<path>", so known revisions need no git call at all */
+	TMap<FString, FString> BlobOids;
+
+	/** Total size of cached blobs in bytes */
+	int64 TotalSize;
+
+	bool bIndexLoaded;
+};
@@ -4,40 +4,55 @@
 
 #include "UeLfsCommand.h"
 #include "Modules/ModuleManager.h"
+#include "HAL/Event.h"
+#include "HAL/PlatformProcess.h"
 #include "UeLfsModule.h"
+#include "UeLfsTrace.h"
 #include "SUeLfsSettings.h"
 
 FUeLfsCommand::FUeLfsCommand(
 	const TSharedRef<class ISourceControlOperation, ESPMode::ThreadSafe>& InOperation,
 	const TSharedRef<class IUeLfsWorker, ESPMode::ThreadSafe>& InWorker,
 	const FSourceControlOperationComplete& InOperationCompleteDelegate)
-	: Operation(InOperation)
+	: Settings(FModuleManager::LoadModuleChecked<FUeLfsModule>("UeLfs").AccessSettings().GetSnapshot())
+	, Operation(InOperation)
 	, Worker(InWorker)
 	, OperationCompleteDelegate(InOperationCompleteDelegate)
 	, bExecuteProcessed(0)
+	, CompletionEvent(FPlatformProcess::GetSynchEventFromPool(true))
 	, bCommandSuccessful(false)
 	, bAutoDelete(true)
 	, Concurrency(EConcurrency::Synchronous)
 {
-	// grab the providers settings here, so we don't access them once the worker thread is launched
 	check(IsInGameThread());
 
-	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>( "UeLfs" );
-	FUeLfsProvider& Provider = UeLfs.GetProvider();
-	ServerUrl = UeLfs.AccessSettings().GetServerUrl();
-	UserName = UeLfs.AccessSettings().GetUserName();
+	RepositoryRoot = Settings->RepoRootPath;
+}
+
+FUeLfsCommand::~FUeLfsCommand()
+{
+	FPlatformProcess::ReturnSynchEventToPool(CompletionEvent);
+	CompletionEvent = nullptr;
 }
 
 bool FUeLfsCommand::DoWork()
 {
-	bCommandSuccessful = Worker->Execute(*this);
+	UELFS_TRACE_SCOPE(UeLfs_DoWork);
+
+	const bool bSuccessful = Worker->Execute(*this);
+	bCommandSuccessful = bSuccessful;
+
+	// Signal before publishing the processed flag: once the flag is set the
+	// game thread may delete this command at any time.
+	CompletionEvent->Trigger();
 	FPlatformAtomics::InterlockedExchange(&bExecuteProcessed, 1);
 
-	return bCommandSuccessful;
+	return bSuccessful;
 }
 
 void FUeLfsCommand::Abandon()
 {
+	CompletionEvent->Trigger();
 	FPlatformAtomics::InterlockedExchange(&bExecuteProcessed, 1);
 }
 
@@ -63,5 +78,29 @@ ECommandResult::Type FUeLfsCommand::ReturnResults()
 	ECommandResult::Type Result = bCommandSuccessful ? ECommandResult::Succeeded : ECommandResult::Failed;
 	OperationCompleteDelegate.ExecuteIfBound(Operation, Result);
 
+	// Hand the results over to any callers that joined this command.
+	for (const FUeLfsCommandJoinRef& Join : Joins)
+	{
+		if (&Join->Operation.Get() != &Operation.Get())
+		{
+			for (FString& String : InfoMessages)
+			{
+				Join->Operation->AddInfoMessge(FText::FromString(String));
+			}
+			for (FString& String : ErrorMessages)
+			{
+				Join->Operation->AddErrorMessge(FText::FromString(String));
+			}
+		}
+
+		Join->bCommandSuccessful &= bCommandSuccessful;
+
+		if (--Join->PendingCount == 0)
+		{
+			Join->OperationCompleteDelegate.ExecuteIfBound(Join->Operation,
+				Join->bCommandSuccessful ? ECommandResult::Succeeded : ECommandResult::Failed);
+		}
+	}
+
 	return Result;
 }
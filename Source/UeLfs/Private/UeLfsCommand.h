@@ -7,6 +7,39 @@
 #include "CoreMinimal.h"
 #include "ISourceControlProvider.h"
 #include "Misc/IQueuedWork.h"
+#include "UeLfsSettings.h"
+
+/**
+ * Completion state shared by every command that an operation was spread across.
+ * The operation's delegate is run once the last of those commands has returned its results.
+ */
+struct FUeLfsCommandJoin
+{
+	FUeLfsCommandJoin(
+		const TSharedRef<class ISourceControlOperation, ESPMode::ThreadSafe>& InOperation,
+		const FSourceControlOperationComplete& InOperationCompleteDelegate,
+		int32 InPendingCount)
+		: Operation(InOperation)
+		, OperationCompleteDelegate(InOperationCompleteDelegate)
+		, PendingCount(InPendingCount)
+		, bCommandSuccessful(true)
+	{
+	}
+
+	/** Operation of the caller that joined */
+	TSharedRef<class ISourceControlOperation, ESPMode::ThreadSafe> Operation;
+
+	/** Delegate to notify when all joined commands have completed */
+	FSourceControlOperationComplete OperationCompleteDelegate;
+
+	/** Number of commands that have not returned their results yet */
+	int32 PendingCount;
+
+	/** If true, every command that has returned so far succeeded */
+	bool bCommandSuccessful;
+};
+
+typedef TSharedRef<FUeLfsCommandJoin, ESPMode::ThreadSafe> FUeLfsCommandJoinRef;
 
 /**
  * Used to execute UeLfs commands multi-threaded.
@@ -21,6 +54,8 @@ public:
 		const FSourceControlOperationComplete& InOperationCompleteDelegate =
 			FSourceControlOperationComplete());
 
+	virtual ~FUeLfsCommand();
+
 	/**
 	 * This is where the real thread work is done. All work that is done for
 	 * this queued object should be done from within the call to this function.
@@ -45,9 +80,9 @@ public:
 	ECommandResult::Type ReturnResults();
 
 public:
-	/** Connection parameters, reproduced here because if is not safe to access the provider's settings from another thread */
-	FString ServerUrl;
-	FString UserName;
+	/** Settings captured when the command was created, so the whole command sees one consistent version */
+	FUeLfsSettingsSnapshotRef Settings;
+
 	FString WorkingCopyRoot;
 	FString RepositoryRoot;
 
@@ -60,9 +95,15 @@ public:
 	/** Delegate to notify when this operation completes */
 	FSourceControlOperationComplete OperationCompleteDelegate;
 
+	/** Callers waiting on this command instead of running their own (see FUeLfsProvider::Execute) */
+	TArray<FUeLfsCommandJoinRef> Joins;
+
 	/**If true, this command has been processed by the source control thread*/
 	volatile int32 bExecuteProcessed;
 
+	/** Triggered once the command has been processed, so synchronous callers can wait on it */
+	FEvent* CompletionEvent;
+
 	/**If true, the source control command succeeded*/
 	bool bCommandSuccessful;
 
@@ -0,0 +1,134 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#include "UeLfsHistory.h"
+#include "Misc/ScopeLock.h"
+#include "Misc/Paths.h"
+#include "ISourceControlModule.h"
+#include "UeLfsUtils.h"
+#include "UeLfsTrace.h"
+
+namespace UeLfsHistoryConstants
+{
+	/** Fields per 'git log' record: hash, author, author time, message */
+	static const int32 NumRecordFields = 4;
+
+	/** Characters of the commit hash shown to users */
+	static const int32 ShortHashLen = 8;
+}
+
+bool FUeLfsHistoryCache::GetHistory(const FString& FilePath, const FString& RepoRootPath,
+	const FString& HeadCommit, FUeLfsHistory& OutHistory)
+{
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		const FEntry* Entry = Entries.Find(FilePath);
+		if (Entry != nullptr && Entry->HeadCommit == HeadCommit)
+		{
+			OutHistory = Entry->History;
+			return true;
+		}
+	}
+
+	// Read outside the lock, so other files can be served meanwhile.
+	FUeLfsHistory History;
+	if (!ReadHistory(FilePath, RepoRootPath, History))
+	{
+		return false;
+	}
+
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		FEntry& Entry = Entries.FindOrAdd(FilePath);
+		Entry.HeadCommit = HeadCommit;
+		Entry.History = History;
+	}
+
+	OutHistory = MoveTemp(History);
+	return true;
+}
+
+void FUeLfsHistoryCache::Invalidate(const TArray<FString>& FilePaths)
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	for (const FString& FilePath : FilePaths)
+	{
+		Entries.Remove(FilePath);
+	}
+}
+
+void FUeLfsHistoryCache::Empty()
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	Entries.Empty();
+}
+
+bool FUeLfsHistoryCache::ReadHistory(const FString& FilePath, const FString& RepoRootPath,
+	FUeLfsHistory& OutHistory)
+{
+	UELFS_TRACE_SCOPE(UeLfs_ReadHistory);
+
+	FString GitFilePath = FilePath;
+	FPaths::MakePathRelativeTo(GitFilePath, *RepoRootPath);
+
+	// One record per commit; fields and records are all separated by NUL (-z).
+	FString ArgStr = FString::Printf(
+		TEXT("-C %s log -z --follow --pretty=format:%%H%%x00%%an%%x00%%at%%x00%%B -- \"%s\""),
+		*RepoRootPath,
+		*GitFilePath);
+
+	// Fields are collected per record as they stream in, so memory stays bounded by one record.
+	TArray<FString> Fields;
+	TArray<TSharedRef<FUeLfsRevision, ESPMode::ThreadSafe>> Revisions;
+	FUeLfsRecordSplitter Splitter('\0', [&Fields, &Revisions, &FilePath, &GitFilePath](const FString& Field)
+	{
+		Fields.Add(Field);
+		if (Fields.Num() < UeLfsHistoryConstants::NumRecordFields)
+		{
+			return;
+		}
+
+		TSharedRef<FUeLfsRevision, ESPMode::ThreadSafe> Revision = MakeShared<FUeLfsRevision, ESPMode::ThreadSafe>();
+		Revision->Filename = FilePath;
+		Revision->RepoFilename = GitFilePath;
+		Revision->CommitId = Fields[0];
+		Revision->Revision = Fields[0].Left(UeLfsHistoryConstants::ShortHashLen);
+		Revision->UserName = Fields[1];
+		Revision->Date = FDateTime::FromUnixTimestamp(FCString::Atoi64(*Fields[2]));
+		Revision->Description = Fields[3].TrimStartAndEnd();
+		Revision->Action = TEXT("edit");
+		Revisions.Add(Revision);
+
+		Fields.Reset();
+	});
+
+	int32 ReturnCode;
+	const bool bOk = UeLfsUtils::RunGitCommandStreamed(ArgStr,
+		[&Splitter](const uint8* Data, int32 Num) { Splitter.Append(Data, Num); },
+		ReturnCode);
+
+	// The last record is not NUL-terminated.
+	Splitter.Flush();
+
+	if (!bOk)
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to get history of %s!"), *GitFilePath);
+		return false;
+	}
+
+	// Newest first, numbered from the oldest.
+	const int32 NumRevisions = Revisions.Num();
+	for (int32 Index = 0; Index < NumRevisions; ++Index)
+	{
+		Revisions[Index]->RevisionNumber = NumRevisions - Index;
+	}
+	if (NumRevisions > 0)
+	{
+		Revisions.Last()->Action = TEXT("add");
+	}
+
+	OutHistory.Append(Revisions);
+
+	return true;
+}
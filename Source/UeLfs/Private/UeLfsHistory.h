@@ -0,0 +1,49 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UeLfsRevision.h"
+
+// History of a file, newest revision first.
+typedef TArray< TSharedRef<FUeLfsRevision, ESPMode::ThreadSafe> > FUeLfsHistory;
+
+/**
+ * File histories keyed by local file path, each valid for the HEAD commit it was read at.
+ * Filled from worker threads, so all access is guarded.
+ */
+class FUeLfsHistoryCache
+{
+public:
+	/**
+	 * Get the history of a file as of HEAD.
+	 * Runs git only if there is no cached history for this HEAD yet.
+	 */
+	bool GetHistory(const FString& FilePath, const FString& RepoRootPath,
+		const FString& HeadCommit, FUeLfsHistory& OutHistory);
+
+	/** Drop cached histories of the files. */
+	void Invalidate(const TArray<FString>& FilePaths);
+
+	/** Drop all cached histories. */
+	void Empty();
+
+private:
+	// Read the history of a file with one 'git log' invocation.
+	static bool ReadHistory(const FString& FilePath, const FString& RepoRootPath,
+		FUeLfsHistory& OutHistory);
+
+private:
+	struct FEntry
+	{
+		FString HeadCommit;
+		FUeLfsHistory History;
+	};
+
+	/** A critical section for cache access */
+	mutable FCriticalSection CriticalSection;
+
+	TMap<FString, FEntry> Entries;
+};
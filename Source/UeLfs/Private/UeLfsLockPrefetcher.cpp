@@ -0,0 +1,336 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#include "UeLfsLockPrefetcher.h"
+#include "Containers/Ticker.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "ISourceControlModule.h"
+#include "AssetRegistryModule.h"
+#include "ContentBrowserModule.h"
+#include "Editor.h"
+#include "Subsystems/AssetEditorSubsystem.h"
+#include "Engine/World.h"
+#include "UeLfsModule.h"
+#include "UeLfsOperations.h"
+#include "UeLfsTrace.h"
+
+namespace UeLfsLockPrefetcherConstants
+{
+	/** Seconds a folder must stay open before it is prefetched, so browsing through folders sends nothing */
+	static const float SettleDelay = 0.3f;
+
+	/** Most files fetched by one prefetch */
+	static const int32 MaxFilesPerPrefetch = 512;
+}
+
+void FUeLfsLockPrefetcher::Startup()
+{
+	FContentBrowserModule& ContentBrowserModule =
+		FModuleManager::LoadModuleChecked<FContentBrowserModule>("ContentBrowser");
+	AssetPathChangedHandle = ContentBrowserModule.GetOnAssetPathChanged().AddRaw(
+		this, &FUeLfsLockPrefetcher::OnAssetPathChanged);
+
+	// The asset editor subsystem comes with the editor engine, which may not exist yet.
+	if (GEditor != nullptr)
+	{
+		BindEditorDelegates();
+	}
+	else
+	{
+		PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddRaw(this, &FUeLfsLockPrefetcher::BindEditorDelegates);
+	}
+}
+
+void FUeLfsLockPrefetcher::BindEditorDelegates()
+{
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	PostEngineInitHandle.Reset();
+
+	if (GEditor == nullptr)
+	{
+		return;
+	}
+
+	MapOpenedHandle = FEditorDelegates::OnMapOpened.AddRaw(this, &FUeLfsLockPrefetcher::OnMapOpened);
+
+	UAssetEditorSubsystem* AssetEditorSubsystem = GEditor->GetEditorSubsystem<UAssetEditorSubsystem>();
+	if (AssetEditorSubsystem != nullptr)
+	{
+		AssetOpenedHandle = AssetEditorSubsystem->OnAssetOpenedInEditor().AddRaw(
+			this, &FUeLfsLockPrefetcher::OnAssetOpened);
+	}
+}
+
+void FUeLfsLockPrefetcher::Shutdown()
+{
+	Cancel();
+
+	if (TickerHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+		TickerHandle.Reset();
+	}
+
+	FContentBrowserModule* ContentBrowserModule =
+		FModuleManager::GetModulePtr<FContentBrowserModule>("ContentBrowser");
+	if (ContentBrowserModule != nullptr)
+	{
+		ContentBrowserModule->GetOnAssetPathChanged().Remove(AssetPathChangedHandle);
+	}
+	AssetPathChangedHandle.Reset();
+
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	PostEngineInitHandle.Reset();
+
+	FEditorDelegates::OnMapOpened.Remove(MapOpenedHandle);
+	MapOpenedHandle.Reset();
+
+	if (GEditor != nullptr && AssetOpenedHandle.IsValid())
+	{
+		UAssetEditorSubsystem* AssetEditorSubsystem = GEditor->GetEditorSubsystem<UAssetEditorSubsystem>();
+		if (AssetEditorSubsystem != nullptr)
+		{
+			AssetEditorSubsystem->OnAssetOpenedInEditor().Remove(AssetOpenedHandle);
+		}
+	}
+	AssetOpenedHandle.Reset();
+}
+
+void FUeLfsLockPrefetcher::OnAssetPathChanged(const FString& NewPath)
+{
+	PrefetchFolder(NewPath);
+}
+
+void FUeLfsLockPrefetcher::OnMapOpened(const FString& Filename, bool bAsTemplate)
+{
+	FString PackageName;
+	if (!bAsTemplate && FPackageName::TryConvertFilenameToLongPackageName(Filename, PackageName))
+	{
+		PrefetchDependencies({ FName(*PackageName) });
+	}
+}
+
+void FUeLfsLockPrefetcher::OnAssetOpened(UObject* Asset, IAssetEditorInstance* AssetEditor)
+{
+	if (Asset != nullptr)
+	{
+		PrefetchDependencies({ Asset->GetOutermost()->GetFName() });
+	}
+}
+
+void FUeLfsLockPrefetcher::PrefetchFolder(const FString& FolderPath)
+{
+	check(IsInGameThread());
+
+	// The previous folder is no longer shown; don't spend a request on it.
+	Cancel();
+
+	PendingFolderPath = FolderPath;
+	LastPathChangeTime = FPlatformTime::Seconds();
+
+	if (!TickerHandle.IsValid())
+	{
+		TickerHandle = FTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateRaw(this, &FUeLfsLockPrefetcher::Tick),
+			UeLfsLockPrefetcherConstants::SettleDelay);
+	}
+}
+
+void FUeLfsLockPrefetcher::PrefetchDependencies(const TArray<FName>& PackageNames)
+{
+	check(IsInGameThread());
+
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	if (!UeLfs.AccessSettings().GetPrefetchDependencies())
+	{
+		return;
+	}
+
+	TArray<FString> Files;
+	GetFilesWithDependencies(PackageNames, Files);
+
+	// Not cancelled by browsing; the asset stays open.
+	IssuePrefetch(Files);
+}
+
+bool FUeLfsLockPrefetcher::Tick(float DeltaTime)
+{
+	if (FPlatformTime::Seconds() - LastPathChangeTime < UeLfsLockPrefetcherConstants::SettleDelay)
+	{
+		return true;
+	}
+
+	TickerHandle.Reset();
+
+	const FString FolderPath = MoveTemp(PendingFolderPath);
+	PendingFolderPath.Reset();
+
+	TArray<FString> Files;
+	GetFolderFiles(FolderPath, Files);
+	Operation = IssuePrefetch(Files);
+
+	return false;
+}
+
+void FUeLfsLockPrefetcher::GetFolderFiles(const FString& FolderPath, TArray<FString>& OutFiles) const
+{
+	UELFS_TRACE_SCOPE(UeLfs_GetFolderFiles);
+
+	// The asset registry already knows the folder; no need to touch the disk.
+	IAssetRegistry& AssetRegistry =
+		FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+	TArray<FAssetData> Assets;
+	AssetRegistry.GetAssetsByPath(FName(*FolderPath), Assets, false);
+
+	TSet<FName> SeenPackages;
+	for (const FAssetData& Asset : Assets)
+	{
+		bool bAlreadySeen = false;
+		SeenPackages.Add(Asset.PackageName, &bAlreadySeen);
+		if (bAlreadySeen)
+		{
+			continue;
+		}
+
+		const FString& Extension = Asset.AssetClass == UWorld::StaticClass()->GetFName()
+			? FPackageName::GetMapPackageExtension()
+			: FPackageName::GetAssetPackageExtension();
+
+		FString FilePath;
+		if (FPackageName::TryConvertLongPackageNameToFilename(Asset.PackageName.ToString(), FilePath, Extension))
+		{
+			OutFiles.Add(FPaths::ConvertRelativePathToFull(FilePath));
+		}
+	}
+}
+
+void FUeLfsLockPrefetcher::GetFilesWithDependencies(const TArray<FName>& PackageNames, TArray<FString>& OutFiles) const
+{
+	UELFS_TRACE_SCOPE(UeLfs_GetFilesWithDependencies);
+
+	IAssetRegistry& AssetRegistry =
+		FModuleManager::LoadModuleChecked<FAssetRegistryModule>("AssetRegistry").Get();
+
+	// The packages themselves, then what they need to load.
+	TArray<FName> AllPackageNames = PackageNames;
+	for (const FName& PackageName : PackageNames)
+	{
+		AssetRegistry.GetDependencies(PackageName, AllPackageNames,
+			UE::AssetRegistry::EDependencyCategory::Package,
+			UE::AssetRegistry::EDependencyQuery::Hard);
+	}
+
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	FUeLfsProvider& Provider = UeLfs.GetProvider();
+
+	TSet<FName> SeenPackages;
+	for (const FName& PackageName : AllPackageNames)
+	{
+		bool bAlreadySeen = false;
+		SeenPackages.Add(PackageName, &bAlreadySeen);
+
+		const FString PackageNameStr = PackageName.ToString();
+		if (bAlreadySeen || FPackageName::IsScriptPackage(PackageNameStr))
+		{
+			continue;
+		}
+
+		// The asset registry knows which packages are on disk, and whether they are maps; no need to touch the disk.
+		TArray<FAssetData> Assets;
+		AssetRegistry.GetAssetsByPackageName(PackageName, Assets, true);
+		if (Assets.Num() == 0)
+		{
+			continue;
+		}
+
+		const bool bIsMap = Assets.ContainsByPredicate([](const FAssetData& Asset)
+		{
+			return Asset.AssetClass == UWorld::StaticClass()->GetFName();
+		});
+		const FString& Extension = bIsMap
+			? FPackageName::GetMapPackageExtension()
+			: FPackageName::GetAssetPackageExtension();
+
+		FString FilePath;
+		if (!FPackageName::TryConvertLongPackageNameToFilename(PackageNameStr, FilePath, Extension))
+		{
+			continue;
+		}
+
+		// Engine and marketplace content outside of any repository can't be locked;
+		// files outside of every repository resolve to the default one without being under it.
+		FilePath = FPaths::ConvertRelativePathToFull(FilePath);
+		if (FPaths::IsUnderDirectory(FilePath, Provider.ResolveRepo(FilePath)->RootPath))
+		{
+			OutFiles.Add(MoveTemp(FilePath));
+		}
+	}
+}
+
+TSharedPtr<FUeLfsPrefetchLockStates, ESPMode::ThreadSafe> FUeLfsLockPrefetcher::IssuePrefetch(const TArray<FString>& Files)
+{
+	// Only when UeLfs is the active provider and talking to a server.
+	ISourceControlModule& SourceControlModule = ISourceControlModule::Get();
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	FUeLfsProvider& Provider = UeLfs.GetProvider();
+	if (!SourceControlModule.IsEnabled() ||
+		SourceControlModule.GetProvider().GetName() != Provider.GetName() ||
+		!UeLfs.GetHttp().IsLoggedIn())
+	{
+		return nullptr;
+	}
+
+	TArray<FString> MissingFiles;
+	for (const FString& FilePath : Files)
+	{
+		if (!Provider.HasKnownLockState(FilePath))
+		{
+			MissingFiles.Add(FilePath);
+			if (MissingFiles.Num() >= UeLfsLockPrefetcherConstants::MaxFilesPerPrefetch)
+			{
+				break;
+			}
+		}
+	}
+
+	if (MissingFiles.Num() == 0)
+	{
+		return nullptr;
+	}
+
+	UE_LOG(LogSourceControl, Verbose, TEXT("[UeLfs] Prefetching lock states of %d file(s)"),
+		MissingFiles.Num());
+
+	TSharedRef<FUeLfsPrefetchLockStates, ESPMode::ThreadSafe> Prefetch =
+		ISourceControlOperation::Create<FUeLfsPrefetchLockStates>();
+	Provider.Execute(Prefetch,
+		MissingFiles,
+		EConcurrency::Asynchronous,
+		FSourceControlOperationComplete::CreateRaw(this, &FUeLfsLockPrefetcher::OnPrefetchComplete));
+
+	return Prefetch;
+}
+
+void FUeLfsLockPrefetcher::Cancel()
+{
+	if (Operation.IsValid())
+	{
+		Operation->Cancel();
+		Operation.Reset();
+	}
+}
+
+void FUeLfsLockPrefetcher::OnPrefetchComplete(const FSourceControlOperationRef& InOperation,
+	ECommandResult::Type InResult)
+{
+	if (Operation.IsValid() && Operation.Get() == &InOperation.Get())
+	{
+		Operation.Reset();
+	}
+}
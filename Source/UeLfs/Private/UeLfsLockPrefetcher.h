@@ -0,0 +1,76 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ISourceControlProvider.h"
+
+class FUeLfsPrefetchLockStates;
+class IAssetEditorInstance;
+
+/**
+ * Fetches lock states ahead of the editor asking for them, with one request per batch:
+ * the assets of the Content Browser folder being viewed, and the hard dependencies of
+ * an asset (or map) being opened.
+ * Runs on the game thread; a newer folder cancels the prefetch of the previous one.
+ */
+class FUeLfsLockPrefetcher
+{
+public:
+	FUeLfsLockPrefetcher()
+		: LastPathChangeTime(0.0)
+	{
+	}
+
+	/** Start following the Content Browser and the asset editors. */
+	void Startup();
+
+	/** Stop following the editor, and cancel what is pending. */
+	void Shutdown();
+
+	/** Prefetch the lock states of the assets directly in a content folder (e.g. "/Game/Maps"). */
+	void PrefetchFolder(const FString& FolderPath);
+
+	/** Prefetch the lock states of the packages' hard dependencies. */
+	void PrefetchDependencies(const TArray<FName>& PackageNames);
+
+	/** Get the files of the packages and of their hard dependencies, limited to the repository. */
+	void GetFilesWithDependencies(const TArray<FName>& PackageNames, TArray<FString>& OutFiles) const;
+
+private:
+	void BindEditorDelegates();
+
+	void OnAssetPathChanged(const FString& NewPath);
+	void OnMapOpened(const FString& Filename, bool bAsTemplate);
+	void OnAssetOpened(UObject* Asset, IAssetEditorInstance* AssetEditor);
+
+	// Issue the folder prefetch once the folder has been shown for a moment.
+	bool Tick(float DeltaTime);
+
+	// Collect the files of the assets directly in a content folder.
+	void GetFolderFiles(const FString& FolderPath, TArray<FString>& OutFiles) const;
+
+	// Fetch the lock states of the files the editor has none for yet, up to the budget.
+	TSharedPtr<FUeLfsPrefetchLockStates, ESPMode::ThreadSafe> IssuePrefetch(const TArray<FString>& Files);
+
+	void Cancel();
+
+	void OnPrefetchComplete(const FSourceControlOperationRef& InOperation, ECommandResult::Type InResult);
+
+private:
+	FDelegateHandle AssetPathChangedHandle;
+	FDelegateHandle MapOpenedHandle;
+	FDelegateHandle AssetOpenedHandle;
+	FDelegateHandle PostEngineInitHandle;
+
+	FDelegateHandle TickerHandle;
+
+	/** Folder waiting to be prefetched, and when it was opened */
+	FString PendingFolderPath;
+	double LastPathChangeTime;
+
+	/** The folder prefetch in flight, if any */
+	TSharedPtr<FUeLfsPrefetchLockStates, ESPMode::ThreadSafe> Operation;
+};
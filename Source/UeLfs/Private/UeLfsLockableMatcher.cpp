@@ -0,0 +1,230 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#include "UeLfsLockableMatcher.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "ISourceControlModule.h"
+#include "UeLfsTrace.h"
+
+namespace UeLfsLockableMatcherConstants
+{
+	/** Seconds between checks of the .gitattributes time stamp */
+	static const double CheckInterval = 2.0;
+
+	/** Rules used when .gitattributes has no lockable patterns */
+	static const TCHAR* DefaultAttributes = TEXT("*.uasset lockable\n*.umap lockable\n");
+}
+
+bool FUeLfsLockableMatcher::IsLockable(const FString& FilePath, const FString& RepoRootPath)
+{
+	FScopeLock ScopeLock(&CriticalSection);
+
+	const FRuleSet& RuleSet = ReloadIfChanged(RepoRootPath);
+
+	// The last matching rule wins; start from the extension rule and look for later globs.
+	int32 BestOrder = INDEX_NONE;
+	bool bLockable = false;
+
+	const FRule* ExtensionRule = RuleSet.ExtensionRules.Find(FPaths::GetExtension(FilePath));
+	if (ExtensionRule != nullptr)
+	{
+		BestOrder = ExtensionRule->Order;
+		bLockable = ExtensionRule->bLockable;
+	}
+
+	if (RuleSet.GlobRules.Num() > 0)
+	{
+		FString RelativePath = FilePath;
+		FPaths::MakePathRelativeTo(RelativePath, *(RepoRootPath / TEXT("")));
+		const FString FileName = FPaths::GetCleanFilename(FilePath);
+
+		for (int32 Index = RuleSet.GlobRules.Num() - 1; Index >= 0 && RuleSet.GlobRules[Index].Order > BestOrder; --Index)
+		{
+			const FGlobRule& Rule = RuleSet.GlobRules[Index];
+			if (MatchGlob(*Rule.Pattern, Rule.bMatchPath ? *RelativePath : *FileName))
+			{
+				bLockable = Rule.bLockable;
+				break;
+			}
+		}
+	}
+
+	return bLockable;
+}
+
+const FUeLfsLockableMatcher::FRuleSet& FUeLfsLockableMatcher::ReloadIfChanged(const FString& RepoRootPath)
+{
+	FRuleSet* RuleSet = RuleSets.Find(RepoRootPath);
+	const bool bKnown = RuleSet != nullptr;
+	if (!bKnown)
+	{
+		RuleSet = &RuleSets.Add(RepoRootPath);
+	}
+
+	const double Now = FPlatformTime::Seconds();
+	if (bKnown && Now - RuleSet->LastCheckTime < UeLfsLockableMatcherConstants::CheckInterval)
+	{
+		return *RuleSet;
+	}
+
+	RuleSet->LastCheckTime = Now;
+
+	const FString AttributesPath = RepoRootPath / TEXT(".gitattributes");
+	const FDateTime TimeStamp = IFileManager::Get().GetTimeStamp(*AttributesPath);
+	if (bKnown && TimeStamp == RuleSet->LoadedTimeStamp)
+	{
+		return *RuleSet;
+	}
+
+	UELFS_TRACE_SCOPE(UeLfs_CompileLockablePatterns);
+
+	RuleSet->LoadedTimeStamp = TimeStamp;
+
+	FString AttributesText;
+	FFileHelper::LoadFileToString(AttributesText, *AttributesPath);
+	Compile(AttributesText, *RuleSet);
+
+	if (RuleSet->ExtensionRules.Num() == 0 && RuleSet->GlobRules.Num() == 0)
+	{
+		Compile(UeLfsLockableMatcherConstants::DefaultAttributes, *RuleSet);
+	}
+
+	UE_LOG(LogSourceControl, Log, TEXT("[UeLfs] Lockable patterns of %s: %d extension(s), %d glob(s)"),
+		*RepoRootPath, RuleSet->ExtensionRules.Num(), RuleSet->GlobRules.Num());
+
+	return *RuleSet;
+}
+
+void FUeLfsLockableMatcher::Compile(const FString& AttributesText, FRuleSet& OutRuleSet)
+{
+	OutRuleSet.ExtensionRules.Reset();
+	OutRuleSet.GlobRules.Reset();
+
+	TArray<FString> Lines;
+	AttributesText.ParseIntoArrayLines(Lines);
+
+	for (int32 Order = 0; Order < Lines.Num(); ++Order)
+	{
+		const FString Line = Lines[Order].TrimStartAndEnd();
+		if (Line.IsEmpty() || Line.StartsWith(TEXT("#")) || Line.StartsWith(TEXT("[attr]")))
+		{
+			continue;
+		}
+
+		TArray<FString> Tokens;
+		Line.ParseIntoArrayWS(Tokens);
+		if (Tokens.Num() < 2)
+		{
+			continue;
+		}
+
+		// Only lines that set or unset 'lockable' say anything about locking; git-lfs ignores the filter.
+		bool bMentionsLockable = false;
+		bool bLockable = false;
+		for (int32 TokenIndex = 1; TokenIndex < Tokens.Num(); ++TokenIndex)
+		{
+			const FString& Token = Tokens[TokenIndex];
+			if (Token == TEXT("lockable") || Token == TEXT("-lockable") || Token == TEXT("!lockable"))
+			{
+				bMentionsLockable = true;
+				bLockable = Token == TEXT("lockable");
+			}
+		}
+
+		if (!bMentionsLockable)
+		{
+			continue;
+		}
+
+		FRule Rule;
+		Rule.Order = Order;
+		Rule.bLockable = bLockable;
+
+		// The common '*.ext' pattern goes to the extension map. Multi-dot ones like '*.tar.gz' are globs,
+		// since a file's extension is only what follows its last dot.
+		FString Pattern = Tokens[0];
+		if (Pattern.StartsWith(TEXT("*.")))
+		{
+			const FString Extension = Pattern.Mid(2);
+			int32 SpecialIndex = INDEX_NONE;
+			if (!Extension.FindChar(TEXT('*'), SpecialIndex) &&
+				!Extension.FindChar(TEXT('?'), SpecialIndex) &&
+				!Extension.FindChar(TEXT('['), SpecialIndex) &&
+				!Extension.FindChar(TEXT('/'), SpecialIndex) &&
+				!Extension.FindChar(TEXT('.'), SpecialIndex))
+			{
+				OutRuleSet.ExtensionRules.Add(Extension, Rule);
+				continue;
+			}
+		}
+
+		FGlobRule GlobRule;
+		GlobRule.Order = Rule.Order;
+		GlobRule.bLockable = Rule.bLockable;
+
+		int32 SlashIndex = INDEX_NONE;
+		GlobRule.bMatchPath = Pattern.FindChar(TEXT('/'), SlashIndex);
+		Pattern.RemoveFromStart(TEXT("/"));
+		GlobRule.Pattern = MoveTemp(Pattern);
+
+		OutRuleSet.GlobRules.Add(MoveTemp(GlobRule));
+	}
+}
+
+bool FUeLfsLockableMatcher::MatchGlob(const TCHAR* Pattern, const TCHAR* Str)
+{
+	for (; *Pattern != TEXT('\0'); ++Pattern, ++Str)
+	{
+		if (*Pattern == TEXT('*'))
+		{
+			// '**' crosses directories, '*' does not.
+			const bool bAnyDepth = Pattern[1] == TEXT('*');
+			const TCHAR* Rest = Pattern + (bAnyDepth ? 2 : 1);
+			if (bAnyDepth && *Rest == TEXT('/'))
+			{
+				// '**/' also matches no directory at all.
+				if (MatchGlob(Rest + 1, Str))
+				{
+					return true;
+				}
+			}
+
+			for (const TCHAR* Tail = Str; ; ++Tail)
+			{
+				if (MatchGlob(Rest, Tail))
+				{
+					return true;
+				}
+
+				if (*Tail == TEXT('\0') || (!bAnyDepth && *Tail == TEXT('/')))
+				{
+					return false;
+				}
+			}
+		}
+
+		if (*Str == TEXT('\0'))
+		{
+			return false;
+		}
+
+		if (*Pattern == TEXT('?'))
+		{
+			if (*Str == TEXT('/'))
+			{
+				return false;
+			}
+		}
+		else if (FChar::ToLower(*Pattern) != FChar::ToLower(*Str))
+		{
+			return false;
+		}
+	}
+
+	return *Str == TEXT('\0');
+}
@@ -0,0 +1,72 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Tells which files are lockable, from the 'lockable' patterns of the .gitattributes at the
+ * root of the repository owning them. The patterns of each repository
+ * are compiled once into an extension map (for the usual '*.ext' patterns) and a short list of
+ * globs, and recompiled only when the file changes. Without any such pattern, .uasset and
+ * .umap files are lockable.
+ * Used from any thread, so all access is guarded.
+ */
+class FUeLfsLockableMatcher
+{
+public:
+	/** Is the file (an absolute path in the repository at RepoRootPath) lockable? */
+	bool IsLockable(const FString& FilePath, const FString& RepoRootPath);
+
+private:
+	/** One relevant .gitattributes line; later lines override earlier ones, like in git */
+	struct FRule
+	{
+		/** Line order, to find the last matching rule */
+		int32 Order;
+
+		bool bLockable;
+	};
+
+	struct FGlobRule : public FRule
+	{
+		FString Pattern;
+
+		/** Patterns with a slash match the path from the root; others match the file name */
+		bool bMatchPath;
+	};
+
+	/** The rules of one repository */
+	struct FRuleSet
+	{
+		/** Time stamp of the .gitattributes the rules were read from */
+		FDateTime LoadedTimeStamp;
+
+		/** When the time stamp was last checked */
+		double LastCheckTime = 0.0;
+
+		/** Last rule for each single-dot '*.ext' pattern, by extension (without the dot) */
+		TMap<FString, FRule> ExtensionRules;
+
+		/** Rules with any other pattern */
+		TArray<FGlobRule> GlobRules;
+	};
+
+	// Get the rules of the repository, recompiled if its .gitattributes changed.
+	const FRuleSet& ReloadIfChanged(const FString& RepoRootPath);
+
+	// Compile the rules of a .gitattributes file.
+	static void Compile(const FString& AttributesText, FRuleSet& OutRuleSet);
+
+	// Match a gitattributes glob ('*', '**' and '?').
+	static bool MatchGlob(const TCHAR* Pattern, const TCHAR* Str);
+
+private:
+	/** A critical section for rule access */
+	FCriticalSection CriticalSection;
+
+	/** Rules by repository root */
+	TMap<FString, FRuleSet> RuleSets;
+};
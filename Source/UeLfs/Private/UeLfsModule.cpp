@@ -4,6 +4,9 @@
 
 #include "UeLfsModule.h"
 #include "Misc/App.h"
+#include "Containers/Ticker.h"
+#include "HAL/PlatformTime.h"
+#include "SourceControlOperations.h"
 #include "Modules/ModuleManager.h"
 #include "UeLfsOperations.h"
 #include "Features/IModularFeatures.h"
@@ -11,14 +14,27 @@
 #include "ISourceControlModule.h"
 #include "UeLfsEditorCommands.h"
 #include "Misc/MessageDialog.h"
-#include "PackagesDialog.h"
+#include "SUeLfsUnlockDialog.h"
+#include "Framework/Application/SlateApplication.h"
+#include "Framework/Docking/TabManager.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "Widgets/Notifications/SNotificationList.h"
 #include "Interfaces/IPluginManager.h"
 #include "Brushes/SlateImageBrush.h"
 #include "Slate/SlateGameResources.h"
 #include "Styling/SlateStyleRegistry.h"
+#include "EditorStyleSet.h"
+#include "ContentBrowserModule.h"
+#include "ContentBrowserDelegates.h"
 
 #define LOCTEXT_NAMESPACE "UeLfs"
 
+namespace UeLfsModuleConstants
+{
+	/** Seconds without further changes before the settings are written to the ini */
+	static const float SaveSettingsDelay = 1.0f;
+}
+
 template<typename Type>
 static TSharedRef<IUeLfsWorker, ESPMode::ThreadSafe> CreateWorker()
 {
@@ -34,20 +50,29 @@ void FUeLfsModule::StartupModule()
 		FGetUeLfsWorker::CreateStatic( &CreateWorker<FUeLfsWorkerUpdateStatus> ));
 	UeLfsProvider.RegisterWorker("CheckOut",
 		FGetUeLfsWorker::CreateStatic(&CreateWorker<FUeLfsWorkerCheckOut>));
+	UeLfsProvider.RegisterWorker("CheckOutBatch",
+		FGetUeLfsWorker::CreateStatic(&CreateWorker<FUeLfsWorkerCheckOutBatch>));
 	UeLfsProvider.RegisterWorker("CheckIn",
 		FGetUeLfsWorker::CreateStatic(&CreateWorker<FUeLfsWorkerCheckIn>));
 	UeLfsProvider.RegisterWorker("Delete",
 		FGetUeLfsWorker::CreateStatic(&CreateWorker<FUeLfsWorkerDelete>));
-
-	// Dummy operations.
 	UeLfsProvider.RegisterWorker("Revert",
 		FGetUeLfsWorker::CreateStatic(&CreateWorker<FUeLfsWorkerRevert>));
-	UeLfsProvider.RegisterWorker("Copy",
-		FGetUeLfsWorker::CreateStatic(&CreateWorker<FUeLfsWorkerCopy>));
 	UeLfsProvider.RegisterWorker("MarkForAdd",
 		FGetUeLfsWorker::CreateStatic(&CreateWorker<FUeLfsWorkerMarkForAdd>));
+	UeLfsProvider.RegisterWorker("Sync",
+		FGetUeLfsWorker::CreateStatic(&CreateWorker<FUeLfsWorkerSync>));
+	UeLfsProvider.RegisterWorker("Unlock",
+		FGetUeLfsWorker::CreateStatic(&CreateWorker<FUeLfsWorkerUnlock>));
+	UeLfsProvider.RegisterWorker("PrefetchLockStates",
+		FGetUeLfsWorker::CreateStatic(&CreateWorker<FUeLfsWorkerPrefetchLockStates>));
+
+	// Dummy operations.
+	UeLfsProvider.RegisterWorker("Copy",
+		FGetUeLfsWorker::CreateStatic(&CreateWorker<FUeLfsWorkerCopy>));
 
 	UeLfsSettings.LoadSettings();
+	UeLfsHttp.Configure(UeLfsProvider.GetRepoResolver());
 
 	IModularFeatures::Get().RegisterModularFeature("SourceControl", &UeLfsProvider);
 
@@ -82,10 +107,38 @@ void FUeLfsModule::StartupModule()
 		FToolBarExtensionDelegate::CreateRaw(this, &FUeLfsModule::AddToolbarExtension));
 
 	LevelEditorModule.GetToolBarExtensibilityManager()->AddExtender(ToolbarExtender);
+
+	// Fetch lock states of whole folders as they are browsed, and of dependencies as assets are opened.
+	LockPrefetcher.Startup();
+
+	// Add 'Check Out With Dependencies' to the asset context menu.
+	FContentBrowserModule& ContentBrowserModule =
+		FModuleManager::LoadModuleChecked<FContentBrowserModule>("ContentBrowser");
+	ContentBrowserModule.GetAllAssetViewContextMenuExtenders().Add(
+		FContentBrowserMenuExtender_SelectedAssets::CreateRaw(this, &FUeLfsModule::OnExtendAssetContextMenu));
+	AssetContextMenuExtenderHandle = ContentBrowserModule.GetAllAssetViewContextMenuExtenders().Last().GetHandle();
 }
 
 void FUeLfsModule::ShutdownModule()
 {
+	// Don't lose a save that is still waiting for its delay.
+	FlushSettings();
+
+	LockPrefetcher.Shutdown();
+
+	// Remove 'Check Out With Dependencies' from the asset context menu.
+	FContentBrowserModule* ContentBrowserModule =
+		FModuleManager::GetModulePtr<FContentBrowserModule>("ContentBrowser");
+	if (ContentBrowserModule != nullptr)
+	{
+		const FDelegateHandle Handle = AssetContextMenuExtenderHandle;
+		ContentBrowserModule->GetAllAssetViewContextMenuExtenders().RemoveAll(
+			[Handle](const FContentBrowserMenuExtender_SelectedAssets& Delegate)
+			{
+				return Delegate.GetHandle() == Handle;
+			});
+	}
+
 	// Shut down the provider, as this module is going away.
 	UeLfsProvider.Close();
 
@@ -109,59 +162,77 @@ FUeLfsSettings& FUeLfsModule::AccessSettings()
 	return UeLfsSettings;
 }
 
-void FUeLfsModule::SaveSettings()
+void FUeLfsModule::RequestSaveSettings()
 {
-	if (FApp::IsUnattended() || IsRunningCommandlet())
+	// Setters that didn't change anything leave nothing to save.
+	if (FApp::IsUnattended() || IsRunningCommandlet() || !UeLfsSettings.IsDirty())
 	{
 		return;
 	}
 
-	UeLfsSettings.SaveSettings();
-}
-
-FUeLfsProvider& FUeLfsModule::GetProvider()
-{
-	return UeLfsProvider;
+	// Restart the delay on every change; the ticker saves once things have settled.
+	LastSettingsChangeTime = FPlatformTime::Seconds();
+	if (!SaveSettingsTickerHandle.IsValid())
+	{
+		SaveSettingsTickerHandle = FTicker::GetCoreTicker().AddTicker(
+			FTickerDelegate::CreateRaw(this, &FUeLfsModule::TickSaveSettings),
+			UeLfsModuleConstants::SaveSettingsDelay);
+	}
 }
 
-FUeLfsHttp& FUeLfsModule::GetHttp()
+void FUeLfsModule::FlushSettings()
 {
-	return UeLfsHttp;
-}
+	if (SaveSettingsTickerHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(SaveSettingsTickerHandle);
+		SaveSettingsTickerHandle.Reset();
+	}
 
-void FUeLfsModule::GetMyLockedItems(TArray<FLfsLockItem>& OutLockedItems)
-{
-	const FString& MyUserName = UeLfsSettings.GetUserName();
+	if (FApp::IsUnattended() || IsRunningCommandlet() || !UeLfsSettings.IsDirty())
+	{
+		return;
+	}
 
-	UeLfsProvider.GetLockedFiles(OutLockedItems, MyUserName);
+	UeLfsSettings.SaveSettings();
 }
 
-bool FUeLfsModule::UnlockSingleAsset(const FLfsLockItem& Ali)
+bool FUeLfsModule::TickSaveSettings(float DeltaTime)
 {
-	UE_LOG(LogSourceControl, Warning, TEXT("[UeLfs] Unlocking all assets ..."));
-
-	if (!UeLfsHttp.IsLoggedIn())
+	if (FPlatformTime::Seconds() - LastSettingsChangeTime < UeLfsModuleConstants::SaveSettingsDelay)
 	{
-		FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("UeLfs_UnlockMsg", "You are not logged in!"));
-		return false;
+		return true;
 	}
 
-	TArray<FLfsLockInfo> LockUpdates;
-	TArray<FLfsLockItem> AliArray;
-	AliArray.Emplace(Ali);
+	SaveSettingsTickerHandle.Reset();
+
+	const FUeLfsSettingsSnapshotRef SavedSettings = UeLfsSettings.GetSavedSnapshot();
+	const FUeLfsSettingsSnapshotRef Settings = UeLfsSettings.GetSnapshot();
+	const bool bConnectionChanged = SavedSettings->ServerUrl != Settings->ServerUrl ||
+		SavedSettings->UserName != Settings->UserName;
+
+	UeLfsSettings.SaveSettings();
 
-	bool bOk = UeLfsHttp.ReqUnlockFiles(AliArray, LockUpdates);
-	if (!bOk)
+	// An established session talks to the old server (or as the old user); connect again, once.
+	if (bConnectionChanged && UeLfsHttp.IsLoggedIn())
 	{
-		FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("UeLfs_UnlockMsg", "Failed to release lock!"));
-		return false;
+		UE_LOG(LogSourceControl, Log, TEXT("[UeLfs] Server or user changed, reconnecting to %s as %s ..."),
+			*Settings->ServerUrl, *Settings->UserName);
+		UeLfsProvider.Execute(ISourceControlOperation::Create<FConnect>(),
+			TArray<FString>(),
+			EConcurrency::Asynchronous);
 	}
 
-	UeLfsProvider.UpdateLockedStates(LockUpdates);
+	return false;
+}
+
+FUeLfsProvider& FUeLfsModule::GetProvider()
+{
+	return UeLfsProvider;
+}
 
-	FText MsgTxt = FText::FromString(FString::Printf(TEXT("Lock released for [%s]"), *Ali.GitFilePath));
-	FMessageDialog::Open(EAppMsgType::Ok, MsgTxt);
-	return true;
+FUeLfsHttp& FUeLfsModule::GetHttp()
+{
+	return UeLfsHttp;
 }
 
 FSlateIcon FUeLfsModule::FUnlockIcon::GetIcon() const
@@ -187,7 +258,7 @@ void FUeLfsModule::AddToolbarExtension(FToolBarBuilder& ToolbarBuilder)
 
 void FUeLfsModule::OnUnlockButtonClicked()
 {
-	UE_LOG(LogSourceControl, Warning, TEXT("[UeLfs] Unlocking assets ..."));
+	UE_LOG(LogSourceControl, Log, TEXT("[UeLfs] Unlocking assets ..."));
 
 	if (!UeLfsHttp.IsLoggedIn())
 	{
@@ -197,77 +268,134 @@ void FUeLfsModule::OnUnlockButtonClicked()
 
 	TArray<FLfsLockItem> LockedItems;
 	UeLfsProvider.GetLockedFiles(LockedItems, UeLfsSettings.GetUserName());
-	if (LockedItems.Num() > 0)
+	if (LockedItems.Num() == 0)
 	{
-		FPackagesDialogModule& PackagesDialogModule = FModuleManager::LoadModuleChecked<FPackagesDialogModule>(TEXT("PackagesDialog"));
-		PackagesDialogModule.CreatePackagesDialog(NSLOCTEXT("PackagesDialogModule", "PackagesDialogTitle", "Unlock Content"), NSLOCTEXT("PackagesDialogModule", "PackagesDialogMessage", "Select content to unlock."));
-		PackagesDialogModule.AddButton(DRT_Save, NSLOCTEXT("PackagesDialogModule", "UnlockSelectedButton", "Unlock Selected"), NSLOCTEXT("PackagesDialogModule", "UnlockSelectedButtonTip", "Attempt to unlock the selected content"));
-		PackagesDialogModule.AddButton(DRT_Cancel, NSLOCTEXT("PackagesDialogModule", "CancelButton", "Cancel"), NSLOCTEXT("PackagesDialogModule", "CancelButtonTip", "Do not unlock any content and cancel the current operation"));
+		FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("UeLfs_NothingLockedMsg", "You have no locked content."));
+		return;
+	}
 
-		for (const FLfsLockItem& Item: LockedItems)
-		{
-			FString PackageName = FPackageName::FilenameToLongPackageName(Item.LocalFilePath);
-			UObject* Obj = nullptr;
-			UPackage* MockPackage = nullptr;
-			Obj = StaticFindObjectFast(UPackage::StaticClass(), nullptr, *PackageName, true);
-			if (Obj && Obj->IsA(UPackage::StaticClass()))
-			{
-				MockPackage = Cast<UPackage>(Obj);
-			}
-			else
-			{
-				MockPackage = LoadPackage(nullptr, *PackageName, LOAD_None);
-			}
+	TSharedRef<SWindow> Window = SNew(SWindow)
+		.Title(LOCTEXT("UeLfs_UnlockTitle", "Unlock Content"))
+		.ClientSize(FVector2D(800.0f, 500.0f))
+		.SupportsMinimize(false)
+		.SupportsMaximize(false);
 
-			//삭제한 경우
-			if (!MockPackage)
-			{
-				MockPackage = NewObject<UPackage>(nullptr, *PackageName, RF_Transient);
-			}
+	TSharedRef<SUeLfsUnlockDialog> Dialog = SNew(SUeLfsUnlockDialog)
+		.LockedItems(LockedItems)
+		.ParentWindow(Window);
 
-			MockPackage->FileName = *Item.LocalFilePath;
-			PackagesDialogModule.AddPackageItem(MockPackage, ECheckBoxState::Unchecked);
-		}
+	Window->SetContent(Dialog);
+	FSlateApplication::Get().AddModalWindow(Window, FGlobalTabmanager::Get()->GetRootWindow());
 
-		TSet<FString> IgnoredPackages;
-		const EDialogReturnType UserResponse = PackagesDialogModule.ShowPackagesDialog(IgnoredPackages);
+	if (Dialog->GetItemsToUnlock().Num() > 0)
+	{
+		UnlockItemsAsync(Dialog->GetItemsToUnlock());
+	}
+}
 
-		if (UserResponse == DRT_Save)
+void FUeLfsModule::UnlockItemsAsync(const TArray<FLfsLockItem>& Items)
+{
+	TArray<FString> FilePaths;
+	for (const FLfsLockItem& Item : Items)
+	{
+		FilePaths.Add(Item.LocalFilePath);
+	}
+
+	UeLfsProvider.Execute(ISourceControlOperation::Create<FUeLfsUnlock>(),
+		FilePaths,
+		EConcurrency::Asynchronous,
+		FSourceControlOperationComplete::CreateRaw(this, &FUeLfsModule::OnUnlockComplete));
+}
+
+void FUeLfsModule::OnUnlockComplete(const FSourceControlOperationRef& InOperation,
+	ECommandResult::Type InResult)
+{
+	const bool bOk = InResult == ECommandResult::Succeeded;
+
+	FNotificationInfo Info(bOk
+		? LOCTEXT("UeLfs_UnlockedMsg", "Selected locks released.")
+		: LOCTEXT("UeLfs_UnlockFailedMsg", "Failed to release locks!"));
+	Info.ExpireDuration = 5.0f;
+	TSharedPtr<SNotificationItem> Notification = FSlateNotificationManager::Get().AddNotification(Info);
+	if (Notification.IsValid())
+	{
+		Notification->SetCompletionState(bOk ? SNotificationItem::CS_Success : SNotificationItem::CS_Fail);
+	}
+}
+
+TSharedRef<FExtender> FUeLfsModule::OnExtendAssetContextMenu(const TArray<FAssetData>& SelectedAssets)
+{
+	TSharedRef<FExtender> Extender = MakeShared<FExtender>();
+
+	ISourceControlModule& SourceControlModule = ISourceControlModule::Get();
+	if (!SourceControlModule.IsEnabled() || SourceControlModule.GetProvider().GetName() != UeLfsProvider.GetName())
+	{
+		return Extender;
+	}
+
+	TArray<FName> PackageNames;
+	for (const FAssetData& Asset : SelectedAssets)
+	{
+		PackageNames.AddUnique(Asset.PackageName);
+	}
+
+	Extender->AddMenuExtension("AssetSourceControlActions",
+		EExtensionHook::After,
+		nullptr,
+		FMenuExtensionDelegate::CreateLambda([this, PackageNames](FMenuBuilder& MenuBuilder)
 		{
-			TArray<UPackage*> PkgsToUnlock;
-			PackagesDialogModule.GetResults(PkgsToUnlock, ECheckBoxState::Checked);
+			MenuBuilder.AddMenuEntry(
+				LOCTEXT("UeLfs_CheckOutWithDependencies", "Check Out With Dependencies"),
+				LOCTEXT("UeLfs_CheckOutWithDependencies_Tooltip", "Check out the selected assets and the assets they need to load, with a single lock request."),
+				FSlateIcon(FEditorStyle::GetStyleSetName(), "SourceControl.Actions.CheckOut"),
+				FUIAction(FExecuteAction::CreateRaw(this, &FUeLfsModule::CheckOutWithDependencies, PackageNames)));
+		}));
+
+	return Extender;
+}
 
-			TArray<FLfsLockItem> SelectedItems;
-			for (UPackage* Package : PkgsToUnlock)
-			{
-				FString FilePath = Package->FileName.ToString();
-				for (const FLfsLockItem& Item : LockedItems)
-				{
-					if (Item.LocalFilePath == FilePath)
-					{
-						UE_LOG(LogSourceControl, Display, TEXT("Selected to unlock : %s"), *FilePath);
-						SelectedItems.Emplace(Item);
-						break;
-					}
-				}
-			}
-
-			if (SelectedItems.Num() > 0)
-			{
-				TArray<FLfsLockInfo> LockUpdates;
-				bool bOk = UeLfsHttp.ReqUnlockFiles(SelectedItems, LockUpdates);
-				if (!bOk)
-				{
-					FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("UeLfs_UnlockMsg", "Failed to release lock!"));
-					return;
-				}
-
-				UeLfsProvider.UpdateLockedStates(LockUpdates);
-
-				FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("UeLfs_UnlockMsg", "All selected locks released!"));
-			}
+void FUeLfsModule::CheckOutWithDependencies(TArray<FName> PackageNames)
+{
+	TArray<FString> Files;
+	LockPrefetcher.GetFilesWithDependencies(PackageNames, Files);
+
+	// Leave out what is already checked out; it needs no new lock.
+	TArray<FSourceControlStateRef> States;
+	UeLfsProvider.GetState(Files, States, EStateCacheUsage::Use);
+	TArray<FString> FilesToCheckOut;
+	for (const FSourceControlStateRef& State : States)
+	{
+		if (!State->IsCheckedOut())
+		{
+			FilesToCheckOut.Add(State->GetFilename());
 		}
 	}
+
+	if (FilesToCheckOut.Num() == 0)
+	{
+		return;
+	}
+
+	UeLfsProvider.Execute(ISourceControlOperation::Create<FUeLfsCheckOutBatch>(),
+		FilesToCheckOut,
+		EConcurrency::Asynchronous,
+		FSourceControlOperationComplete::CreateRaw(this, &FUeLfsModule::OnCheckOutComplete));
+}
+
+void FUeLfsModule::OnCheckOutComplete(const FSourceControlOperationRef& InOperation,
+	ECommandResult::Type InResult)
+{
+	const bool bOk = InResult == ECommandResult::Succeeded;
+
+	FNotificationInfo Info(bOk
+		? LOCTEXT("UeLfs_CheckedOutMsg", "Assets and their dependencies checked out.")
+		: LOCTEXT("UeLfs_CheckOutFailedMsg", "Failed to check out assets and their dependencies!"));
+	Info.ExpireDuration = 5.0f;
+	TSharedPtr<SNotificationItem> Notification = FSlateNotificationManager::Get().AddNotification(Info);
+	if (Notification.IsValid())
+	{
+		Notification->SetCompletionState(bOk ? SNotificationItem::CS_Success : SNotificationItem::CS_Fail);
+	}
 }
 
 IMPLEMENT_MODULE(FUeLfsModule, UeLfs);
@@ -9,6 +9,8 @@
 #include "UeLfsSettings.h"
 #include "UeLfsProvider.h"
 #include "UeLfsUtils.h"
+#include "UeLfsLockPrefetcher.h"
+#include "AssetData.h"
 #include "Framework/MultiBox/MultiBoxBuilder.h"
 #include "Styling/SlateStyle.h"
 
@@ -20,17 +22,16 @@ public:
 	virtual void ShutdownModule() override;
 
 	FUeLfsSettings& AccessSettings();
-	void SaveSettings();
 
-	FUeLfsProvider& GetProvider();
+	// Save the settings once they stop changing for a moment. (debounced; see FlushSettings)
+	void RequestSaveSettings();
 
-	FUeLfsHttp& GetHttp();
+	// Write pending settings changes now.
+	void FlushSettings();
 
-	// Get all locked items by me.
-	void GetMyLockedItems(TArray<FLfsLockItem>& OutLockedItems);
+	FUeLfsProvider& GetProvider();
 
-	// Unlock a single asset.
-	bool UnlockSingleAsset(const FLfsLockItem& Ali);
+	FUeLfsHttp& GetHttp();
 
 private:
 
@@ -41,6 +42,14 @@ private:
 
 	FUeLfsHttp UeLfsHttp;
 
+	FUeLfsLockPrefetcher LockPrefetcher;
+
+	/** Pending debounced settings save, if any */
+	FDelegateHandle SaveSettingsTickerHandle;
+
+	/** When the settings last changed, in FPlatformTime::Seconds() */
+	double LastSettingsChangeTime = 0.0;
+
 	TSharedPtr<FSlateStyleSet> SlateStyleSet;
 
 	class FUnlockIcon
@@ -51,6 +60,11 @@ private:
 	};
 	TSharedPtr<FUnlockIcon> UnlockIconPtr;
 
+private:
+
+	// Save the settings once the delay has passed since the last change.
+	bool TickSaveSettings(float DeltaTime);
+
 private: // For custom 'unlock' button.
 
 	TSharedPtr<FExtender> ToolbarExtender;
@@ -58,4 +72,20 @@ private: // For custom 'unlock' button.
 	void AddToolbarExtension(FToolBarBuilder& ToolbarBuilder);
 
 	void OnUnlockButtonClicked();
+
+	// Release the locks with one async provider command, so no editor frame waits on the server.
+	void UnlockItemsAsync(const TArray<FLfsLockItem>& Items);
+
+	void OnUnlockComplete(const FSourceControlOperationRef& InOperation, ECommandResult::Type InResult);
+
+private: // For the asset context menu.
+
+	FDelegateHandle AssetContextMenuExtenderHandle;
+
+	TSharedRef<FExtender> OnExtendAssetContextMenu(const TArray<FAssetData>& SelectedAssets);
+
+	// Lock the packages and their hard dependencies with one async provider command.
+	void CheckOutWithDependencies(TArray<FName> PackageNames);
+
+	void OnCheckOutComplete(const FSourceControlOperationRef& InOperation, ECommandResult::Type InResult);
 };
@@ -5,14 +5,22 @@
 #include "UeLfsOperations.h"
 #include "HAL/PlatformFilemanager.h"
 #include "HAL/FileManager.h"
+#include "Async/Async.h"
 #include "Modules/ModuleManager.h"
 #include "SourceControlOperations.h"
 #include "ISourceControlModule.h"
 #include "UeLfsCommand.h"
 #include "UeLfsModule.h"
+#include "UeLfsTrace.h"
 
 #define LOCTEXT_NAMESPACE "UeLfs"
 
+namespace UeLfsOperationsConstants
+{
+	/** Number of files that move through the check-out pipeline together */
+	static const int32 CheckOutChunkSize = 32;
+}
+
 //-----------------------------------------------------------------------------
 // "Connect" worker impl.
 //-----------------------------------------------------------------------------
@@ -24,23 +32,26 @@ FName FUeLfsWorkerConnect::GetName() const
 
 bool FUeLfsWorkerConnect::Execute(FUeLfsCommand& InCommand)
 {
+	UELFS_TRACE_SCOPE(FUeLfsWorkerConnect_Execute);
+
 	check(InCommand.Operation->GetName() == GetName());
 
 	InCommand.bCommandSuccessful = true;
 
-	// Configure http connector.
 	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
-	FUeLfsSettings& Settings = UeLfs.AccessSettings();
+	const FUeLfsSettingsSnapshot& Settings = *InCommand.Settings;
 	FUeLfsHttp& AlHttp = UeLfs.GetHttp();
-	AlHttp.Configure(Settings);
 
 	TArray<FString> LockedGitPaths;
-	bool bOk = AlHttp.ReqLogin(LockedGitPaths);
+	bool bOk = AlHttp.ReqLogin(Settings, LockedGitPaths);
 
 	if (bOk)
 	{
-		const FString& UserName = Settings.GetUserName();
-		const FString& RepoRootPath = Settings.GetRepoRootPath();
+		const FString& UserName = Settings.UserName;
+		const FString& RepoRootPath = InCommand.RepositoryRoot;
+
+		// Not being able to tell outdated files is no reason to fail connecting.
+		UeLfs.GetProvider().GetOutdatedFiles().Refresh(RepoRootPath);
 
 		for (const FString& GitPath : LockedGitPaths)
 		{
@@ -52,6 +63,43 @@ bool FUeLfsWorkerConnect::Execute(FUeLfsCommand& InCommand)
 
 			LockInfos.Emplace(Ali);
 		}
+
+		// One snapshot of the whole lock table, so browsing needs no per-file lock queries.
+		// Optional: it is an optimization, and older servers do not have it.
+		TArray<FLfsLockInfo> AllLockInfos;
+		TArray<FString> TrackedFiles;
+		if (Settings.bPrimeLockTable &&
+			AlHttp.ReqGetAllLocks(Settings, AllLockInfos) &&
+			UeLfsUtils::ListTrackedFiles(RepoRootPath, TrackedFiles))
+		{
+			TSet<FString> LockedFiles;
+			for (const FLfsLockInfo& Ali : AllLockInfos)
+			{
+				LockedFiles.Add(Ali.FilePath);
+			}
+
+			// Only lockable files get a state; sources and configs would only bloat the cache.
+			FUeLfsProvider& Provider = UeLfs.GetProvider();
+			TrackedFiles.RemoveAll([&Provider](const FString& FilePath)
+			{
+				return !Provider.IsLockable(FilePath);
+			});
+
+			LockInfos.Reserve(LockInfos.Num() + TrackedFiles.Num() + AllLockInfos.Num());
+			for (const FString& FilePath : TrackedFiles)
+			{
+				if (!LockedFiles.Contains(FilePath))
+				{
+					FLfsLockInfo Ali;
+					Ali.FilePath = FilePath;
+					LockInfos.Emplace(Ali);
+				}
+			}
+			LockInfos.Append(AllLockInfos);
+
+			UE_LOG(LogSourceControl, Log, TEXT("[UeLfs] Primed lock states of %d file(s), %d locked."),
+				TrackedFiles.Num(), AllLockInfos.Num());
+		}
 	}
 
 	InCommand.bCommandSuccessful = bOk;
@@ -62,7 +110,9 @@ bool FUeLfsWorkerConnect::UpdateStates() const
 {
 	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
 	FUeLfsProvider& Provider = UeLfs.GetProvider();
+	Provider.UpdateOutdatedStates();
 	Provider.UpdateLockedStates(LockInfos);
+	Provider.RefreshPathTrie();
 	return true;
 }
 
@@ -78,6 +128,8 @@ FName FUeLfsWorkerUpdateStatus::GetName() const
 //-----------------------------------------------------------------------------
 bool FUeLfsWorkerUpdateStatus::Execute(FUeLfsCommand& InCommand)
 {
+	UELFS_TRACE_SCOPE(FUeLfsWorkerUpdateStatus_Execute);
+
 	// update using any special hints passed in via the operation
 	check(InCommand.Operation->GetName() == GetName());
 
@@ -92,14 +144,41 @@ bool FUeLfsWorkerUpdateStatus::Execute(FUeLfsCommand& InCommand)
 	// First update lock states.
 	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
 	FUeLfsHttp& AlHttp = UeLfs.GetHttp();
-	bool bOk = AlHttp.ReqGetLockStates(InCommand.Files, LockInfos);
+	bool bOk = AlHttp.ReqGetLockStates(*InCommand.Settings, InCommand.RepositoryRoot, InCommand.Files, LockInfos);
+
+	const FString& RepoRootPath = InCommand.RepositoryRoot;
 
 	if (bOk)
 	{
-		const FString& RepoRootPath = UeLfs.AccessSettings().GetRepoRootPath();
 		bOk = UeLfsUtils::GetAddedFiles(InCommand.Files, RepoRootPath, AddedFiles);
 	}
 
+	// Cheap unless HEAD or upstream moved (e.g. after a fetch).
+	if (bOk)
+	{
+		bOk = UeLfs.GetProvider().GetOutdatedFiles().Refresh(RepoRootPath);
+	}
+
+	// Histories are only read on request, once per file and HEAD.
+	TSharedRef<FUpdateStatus, ESPMode::ThreadSafe> Operation = StaticCastSharedRef<FUpdateStatus>(InCommand.Operation);
+	if (bOk && Operation->ShouldUpdateHistory())
+	{
+		const FString HeadCommit = UeLfsUtils::GetHeadCommit(RepoRootPath);
+		FUeLfsHistoryCache& HistoryCache = UeLfs.GetProvider().GetHistoryCache();
+		const TSet<FString> AddedFileSet(AddedFiles);
+
+		for (const FString& FilePath : InCommand.Files)
+		{
+			if (AddedFileSet.Contains(FilePath))
+			{
+				continue;
+			}
+
+			FUeLfsHistory& History = Histories.Add(FilePath);
+			bOk &= HistoryCache.GetHistory(FilePath, RepoRootPath, HeadCommit, History);
+		}
+	}
+
 	InCommand.bCommandSuccessful = bOk;
 	return InCommand.bCommandSuccessful;
 }
@@ -109,8 +188,11 @@ bool FUeLfsWorkerUpdateStatus::UpdateStates() const
 {
 	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
 	FUeLfsProvider& Provider = UeLfs.GetProvider();
+	Provider.UpdateOutdatedStates();
 	Provider.UpdateLockedStates(LockInfos);
 	Provider.UpdateAddedStates(AddedFiles);
+	Provider.UpdateHistories(Histories);
+	Provider.RefreshPathTrie();
 	return true;
 }
 
@@ -126,6 +208,8 @@ FName FUeLfsWorkerCheckOut::GetName() const
 //-----------------------------------------------------------------------------
 bool FUeLfsWorkerCheckOut::Execute(FUeLfsCommand& InCommand)
 {
+	UELFS_TRACE_SCOPE(FUeLfsWorkerCheckOut_Execute);
+
 	UE_LOG(LogSourceControl, Warning, TEXT("[zz] FUeLfsWorkerCheckOut::Execute"));
 
 	// update using any special hints passed in via the operation
@@ -140,21 +224,125 @@ bool FUeLfsWorkerCheckOut::Execute(FUeLfsCommand& InCommand)
 	}
 
 	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
-	FUeLfsProvider& Provider = UeLfs.GetProvider();
-	TArray<FLfsLockItem> LockItems =
-		Provider.MakeLockItems(UeLfs.AccessSettings().GetRepoRootPath(), InCommand.Files);
+	const FString& RepoRootPath = InCommand.RepositoryRoot;
 	FUeLfsHttp& AlHttp = UeLfs.GetHttp();
-	bool bOk = AlHttp.ReqLockFiles(LockItems, LockInfos);
 
-	if (bOk)
+	// Locking a file that changed upstream only leads to a conflict; pull first.
+	FUeLfsOutdatedFiles& OutdatedFiles = UeLfs.GetProvider().GetOutdatedFiles();
+	OutdatedFiles.Refresh(RepoRootPath);
+	for (const FString& FilePath : InCommand.Files)
+	{
+		if (OutdatedFiles.IsOutdated(FilePath))
+		{
+			InCommand.ErrorMessages.Add(FString::Printf(
+				TEXT("%s is not at the latest revision. Pull before checking it out."), *FilePath));
+		}
+	}
+
+	if (InCommand.ErrorMessages.Num() > 0)
+	{
+		InCommand.bCommandSuccessful = false;
+		return InCommand.bCommandSuccessful;
+	}
+
+	// Files move through the stages (hash -> lock -> file attributes) in chunks,
+	// so hashes of the next chunk are resolved while the current one is being locked.
+	const int32 ChunkSize = bSingleRequest
+		? InCommand.Files.Num()
+		: UeLfsOperationsConstants::CheckOutChunkSize;
+	TArray<TArray<FString>> Chunks;
+	for (int32 Index = 0; Index < InCommand.Files.Num(); Index += ChunkSize)
+	{
+		const int32 Count = FMath::Min(ChunkSize, InCommand.Files.Num() - Index);
+		Chunks.Emplace(InCommand.Files.GetData() + Index, Count);
+	}
+
+	// Hashes are resolved a chunk ahead on a thread of their own, not on the thread pool:
+	// this command already holds a pool thread, and waiting on other pool work could leave
+	// every pool thread waiting.
+	TArray<TPromise<TArray<FLfsLockItem>>> ChunkPromises;
+	ChunkPromises.SetNum(Chunks.Num());
+	TArray<TFuture<TArray<FLfsLockItem>>> ChunkFutures;
+	for (TPromise<TArray<FLfsLockItem>>& ChunkPromise : ChunkPromises)
+	{
+		ChunkFutures.Add(ChunkPromise.GetFuture());
+	}
+
+	TAtomic<bool> bStopResolving(false);
+	auto ResolveChunks = [&Chunks, &ChunkPromises, &bStopResolving, &RepoRootPath]()
+	{
+		for (int32 ChunkIndex = 0; ChunkIndex < Chunks.Num(); ++ChunkIndex)
+		{
+			TArray<FLfsLockItem> ChunkItems;
+			if (!bStopResolving)
+			{
+				UeLfsUtils::MakeLockItems(Chunks[ChunkIndex], RepoRootPath, ChunkItems);
+			}
+			ChunkPromises[ChunkIndex].SetValue(MoveTemp(ChunkItems));
+		}
+	};
+
+	// A single chunk has nothing to overlap with.
+	TFuture<void> ResolveDone;
+	if (Chunks.Num() > 1)
+	{
+		ResolveDone = Async(EAsyncExecution::Thread, ResolveChunks);
+	}
+	else
+	{
+		ResolveChunks();
+	}
+
+	bool bOk = true;
+	TArray<FLfsLockItem> AcquiredItems;
+	for (int32 ChunkIndex = 0; bOk && ChunkIndex < Chunks.Num(); ++ChunkIndex)
+	{
+		const TArray<FLfsLockItem> ChunkItems = ChunkFutures[ChunkIndex].Get();
+
+		LockItems.Append(ChunkItems);
+
+		bOk = AlHttp.ReqLockFiles(*InCommand.Settings, RepoRootPath, ChunkItems, LockInfos);
+
+		if (bOk)
+		{
+			AcquiredItems.Append(ChunkItems);
+
+			// Comment copied from FSubversionCheckOutWorker::Execute().
+			// "Annoyingly, we need remove any read-only flags here (for cross-working with Perforce)"
+			for (const FLfsLockItem& Item : ChunkItems)
+			{
+				FPlatformFileManager::Get().GetPlatformFile().SetReadOnly(*Item.LocalFilePath, false);
+
+				ModifiedFiles.Add(Item.LocalFilePath);
+			}
+		}
+	}
+
+	// The resolving thread refers to locals; let it finish before they go away.
+	bStopResolving = true;
+	if (ResolveDone.IsValid())
 	{
-		// Comment copied from FSubversionCheckOutWorker::Execute().
-		// "Annoyingly, we need remove any read-only flags here (for cross-working with Perforce)"
-		for (auto Iter(InCommand.Files.CreateConstIterator()); Iter; Iter++)
+		ResolveDone.Wait();
+	}
+
+	if (!bOk && AcquiredItems.Num() > 0)
+	{
+		// A failed check-out should not leave the earlier chunks locked, or writable.
+		TArray<FLfsLockInfo> UnlockInfos;
+		if (AlHttp.ReqUnlockFiles(*InCommand.Settings, RepoRootPath, AcquiredItems, UnlockInfos))
 		{
-			FPlatformFileManager::Get().GetPlatformFile().SetReadOnly(**Iter, false);
+			for (const FLfsLockItem& Item : AcquiredItems)
+			{
+				FPlatformFileManager::Get().GetPlatformFile().SetReadOnly(*Item.LocalFilePath, true);
+			}
 
-			ModifiedFiles.Add(**Iter);
+			LockInfos = MoveTemp(UnlockInfos);
+			ModifiedFiles.Reset();
+		}
+		else
+		{
+			InCommand.ErrorMessages.Add(FString::Printf(
+				TEXT("Check-out failed and %d file(s) locked by it could not be unlocked."), AcquiredItems.Num()));
 		}
 	}
 
@@ -167,11 +355,22 @@ bool FUeLfsWorkerCheckOut::UpdateStates() const
 {
 	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
 	FUeLfsProvider& Provider = UeLfs.GetProvider();
+	Provider.UpdateOutdatedStates();
+	Provider.UpdateLastCommitHashes(LockItems);
 	Provider.UpdateLockedStates(LockInfos);
 	Provider.UpdateModifiedStates(ModifiedFiles);
 	return true;
 }
 
+//-----------------------------------------------------------------------------
+// "CheckOutBatch" worker impl.
+//-----------------------------------------------------------------------------
+
+FName FUeLfsWorkerCheckOutBatch::GetName() const
+{
+	return "CheckOutBatch";
+}
+
 //-----------------------------------------------------------------------------
 // "CheckIn" worker impl.
 //-----------------------------------------------------------------------------
@@ -184,22 +383,60 @@ FName FUeLfsWorkerCheckIn::GetName() const
 //-----------------------------------------------------------------------------
 bool FUeLfsWorkerCheckIn::Execute(FUeLfsCommand& InCommand)
 {
+	UELFS_TRACE_SCOPE(FUeLfsWorkerCheckIn_Execute);
+
 	check(InCommand.Operation->GetName() == GetName());
 
 	InCommand.bCommandSuccessful = true;
 
 	if (InCommand.Files.Num() == 0)
 	{
-		UE_LOG(LogSourceControl, Warning, TEXT("[TEMP] Revert with zero files."));
 		return InCommand.bCommandSuccessful;
 	}
 
 	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
-	FUeLfsProvider& Provider = UeLfs.GetProvider();
-	TArray<FLfsLockItem> LockItems =
-		Provider.MakeLockItems(UeLfs.AccessSettings().GetRepoRootPath(), InCommand.Files);
-	FUeLfsHttp& AlHttp = UeLfs.GetHttp();
-	bool bOk = AlHttp.ReqUnlockFiles(LockItems, LockInfos);
+	const FString& RepoRootPath = InCommand.RepositoryRoot;
+	const FString& PushRemote = InCommand.Settings->PushRemote;
+
+	TSharedRef<FCheckIn, ESPMode::ThreadSafe> Operation = StaticCastSharedRef<FCheckIn>(InCommand.Operation);
+
+	// One commit for the whole file set, then (optionally) one push, then one unlock.
+	bool bOk = UeLfsUtils::CommitFiles(InCommand.Files, RepoRootPath,
+		Operation->GetDescription().ToString(), CommitHash);
+
+	if (bOk && !CommitHash.IsEmpty() && !PushRemote.IsEmpty())
+	{
+		bOk = UeLfsUtils::PushHead(RepoRootPath, PushRemote);
+		if (!bOk)
+		{
+			// Others would lock the files again before they can see this commit.
+			InCommand.ErrorMessages.Add(FString::Printf(
+				TEXT("Committed %s locally, but pushing to '%s' failed. The files stay locked."),
+				*CommitHash.Left(8), *PushRemote));
+		}
+	}
+
+	if (bOk)
+	{
+		CheckedInFiles = InCommand.Files;
+
+		TArray<FLfsLockInfo> LockInfos;
+		FUeLfsHttp& AlHttp = UeLfs.GetHttp();
+		bLocksReleased = AlHttp.ReqUnlockFiles(*InCommand.Settings, RepoRootPath, UeLfsUtils::MakeUnlockItems(InCommand.Files, RepoRootPath), LockInfos);
+
+		if (!bLocksReleased)
+		{
+			InCommand.ErrorMessages.Add(TEXT("Files were checked in but their locks could not be released."));
+			bOk = false;
+		}
+	}
+
+	if (bOk)
+	{
+		Operation->SetSuccessMessage(CommitHash.IsEmpty()
+			? LOCTEXT("CheckIn_NothingToCommit", "No changes to submit; locks released.")
+			: FText::Format(LOCTEXT("CheckIn_Committed", "Submitted commit {0}."), FText::FromString(CommitHash.Left(8))));
+	}
 
 	InCommand.bCommandSuccessful = bOk;
 	return InCommand.bCommandSuccessful;
@@ -210,7 +447,7 @@ bool FUeLfsWorkerCheckIn::UpdateStates() const
 {
 	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
 	FUeLfsProvider& Provider = UeLfs.GetProvider();
-	Provider.UpdateLockedStates(LockInfos);
+	Provider.UpdateCheckedInStates(CheckedInFiles, CommitHash, bLocksReleased);
 	return true;
 }
 
@@ -226,6 +463,8 @@ FName FUeLfsWorkerDelete::GetName() const
 //-----------------------------------------------------------------------------
 bool FUeLfsWorkerDelete::Execute(FUeLfsCommand& InCommand)
 {
+	UELFS_TRACE_SCOPE(FUeLfsWorkerDelete_Execute);
+
 	// update using any special hints passed in via the operation
 	check(InCommand.Operation->GetName() == GetName());
 
@@ -238,23 +477,29 @@ bool FUeLfsWorkerDelete::Execute(FUeLfsCommand& InCommand)
 	}
 
 	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
-	FUeLfsProvider& Provider = UeLfs.GetProvider();
-	TArray<FLfsLockItem> LockItems =
-		Provider.MakeLockItems(UeLfs.AccessSettings().GetRepoRootPath(), InCommand.Files);
+	const FString& RepoRootPath = InCommand.RepositoryRoot;
+
+	// The files are about to go away; their last commit hashes would cost a 'git log' each for nothing.
+	const TArray<FLfsLockItem> LockItems = UeLfsUtils::MakeUnlockItems(InCommand.Files, RepoRootPath);
 	FUeLfsHttp& AlHttp = UeLfs.GetHttp();
-	bool bOk = AlHttp.ReqLockFiles(LockItems, LockInfos);
+	bool bOk = AlHttp.ReqLockFiles(*InCommand.Settings, RepoRootPath, LockItems, LockInfos);
 
 	if (bOk)
 	{
-		for (auto Iter(InCommand.Files.CreateConstIterator()); Iter; Iter++)
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		for (const FString& FilePath : InCommand.Files)
 		{
-			if (!FPlatformFileManager::Get().GetPlatformFile().DeleteFile(**Iter))
+			if (PlatformFile.FileExists(*FilePath) && !PlatformFile.DeleteFile(*FilePath))
 			{
-				UE_LOG(LogSourceControl, Error, TEXT("Failed to delete file: %s"), **Iter);
+				UE_LOG(LogSourceControl, Error, TEXT("Failed to delete file: %s"), *FilePath);
 			}
+		}
 
-			// Save deleted files.
-			DeletedFiles.Add(**Iter);
+		// Tell git about the whole batch at once.
+		bOk = UeLfsUtils::UpdateIndex(InCommand.Files, RepoRootPath, true);
+		if (bOk)
+		{
+			DeletedFiles = InCommand.Files;
 		}
 	}
 
@@ -273,7 +518,7 @@ bool FUeLfsWorkerDelete::UpdateStates() const
 }
 
 //-----------------------------------------------------------------------------
-// "Revert" worker impl. (dummy)
+// "Revert" worker impl.
 //-----------------------------------------------------------------------------
 
 FName FUeLfsWorkerRevert::GetName() const
@@ -284,13 +529,48 @@ FName FUeLfsWorkerRevert::GetName() const
 //-----------------------------------------------------------------------------
 bool FUeLfsWorkerRevert::Execute(FUeLfsCommand& InCommand)
 {
+	UELFS_TRACE_SCOPE(FUeLfsWorkerRevert_Execute);
+
+	check(InCommand.Operation->GetName() == GetName());
+
 	InCommand.bCommandSuccessful = true;
+
+	if (InCommand.Files.Num() == 0)
+	{
+		UE_LOG(LogSourceControl, Warning, TEXT("[TEMP] Revert with zero files."));
+		return InCommand.bCommandSuccessful;
+	}
+
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	const FString& RepoRootPath = InCommand.RepositoryRoot;
+
+	// Restore every file in one batch first; locks are only released once that worked.
+	bool bOk = UeLfsUtils::RevertFiles(InCommand.Files, RepoRootPath, RevertedFiles, UnstagedFiles);
+
+	if (bOk)
+	{
+		// Unlocking only needs paths, so skip the hash lookup of MakeLockItems().
+		TArray<FLfsLockInfo> LockInfos;
+		FUeLfsHttp& AlHttp = UeLfs.GetHttp();
+		bLocksReleased = AlHttp.ReqUnlockFiles(*InCommand.Settings, RepoRootPath, UeLfsUtils::MakeUnlockItems(InCommand.Files, RepoRootPath), LockInfos);
+
+		if (!bLocksReleased)
+		{
+			InCommand.ErrorMessages.Add(TEXT("Files were reverted but their locks could not be released."));
+			bOk = false;
+		}
+	}
+
+	InCommand.bCommandSuccessful = bOk;
 	return InCommand.bCommandSuccessful;
 }
 
 //-----------------------------------------------------------------------------
 bool FUeLfsWorkerRevert::UpdateStates() const
 {
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	FUeLfsProvider& Provider = UeLfs.GetProvider();
+	Provider.UpdateRevertedStates(RevertedFiles, UnstagedFiles, bLocksReleased);
 	return true;
 }
 
@@ -306,6 +586,8 @@ FName FUeLfsWorkerCopy::GetName() const
 //-----------------------------------------------------------------------------
 bool FUeLfsWorkerCopy::Execute(FUeLfsCommand& InCommand)
 {
+	UELFS_TRACE_SCOPE(FUeLfsWorkerCopy_Execute);
+
 	InCommand.bCommandSuccessful = true;
 	return InCommand.bCommandSuccessful;
 }
@@ -317,7 +599,7 @@ bool FUeLfsWorkerCopy::UpdateStates() const
 }
 
 //-----------------------------------------------------------------------------
-// "MarkForAdd" worker impl. (dummy)
+// "MarkForAdd" worker impl.
 //-----------------------------------------------------------------------------
 
 FName FUeLfsWorkerMarkForAdd::GetName() const
@@ -328,13 +610,181 @@ FName FUeLfsWorkerMarkForAdd::GetName() const
 //-----------------------------------------------------------------------------
 bool FUeLfsWorkerMarkForAdd::Execute(FUeLfsCommand& InCommand)
 {
+	UELFS_TRACE_SCOPE(FUeLfsWorkerMarkForAdd_Execute);
+
+	check(InCommand.Operation->GetName() == GetName());
+
 	InCommand.bCommandSuccessful = true;
+
+	if (InCommand.Files.Num() == 0)
+	{
+		return InCommand.bCommandSuccessful;
+	}
+
+	const FString& RepoRootPath = InCommand.RepositoryRoot;
+
+	// One 'git update-index' for the whole batch, however many files an import brings in.
+	bool bOk = UeLfsUtils::UpdateIndex(InCommand.Files, RepoRootPath, false);
+	if (bOk)
+	{
+		AddedFiles = InCommand.Files;
+	}
+
+	InCommand.bCommandSuccessful = bOk;
 	return InCommand.bCommandSuccessful;
 }
 
 //-----------------------------------------------------------------------------
 bool FUeLfsWorkerMarkForAdd::UpdateStates() const
 {
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	FUeLfsProvider& Provider = UeLfs.GetProvider();
+	Provider.UpdateAddedStates(AddedFiles);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// "Sync" worker impl.
+//-----------------------------------------------------------------------------
+
+FName FUeLfsWorkerSync::GetName() const
+{
+	return "Sync";
+}
+
+//-----------------------------------------------------------------------------
+bool FUeLfsWorkerSync::Execute(FUeLfsCommand& InCommand)
+{
+	UELFS_TRACE_SCOPE(FUeLfsWorkerSync_Execute);
+
+	check(InCommand.Operation->GetName() == GetName());
+
+	InCommand.bCommandSuccessful = true;
+
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	const FString& RepoRootPath = InCommand.RepositoryRoot;
+	const FString& PullRemote = InCommand.Settings->PullRemote;
+	FUeLfsProvider& Provider = UeLfs.GetProvider();
+
+	// Git syncs the whole branch, whichever files were asked for.
+	const FString OldHeadCommit = UeLfsUtils::GetHeadCommit(RepoRootPath);
+	bool bOk = !OldHeadCommit.IsEmpty() && UeLfsUtils::PullFastForward(RepoRootPath, PullRemote);
+
+	const FString NewHeadCommit = bOk ? UeLfsUtils::GetHeadCommit(RepoRootPath) : FString();
+	if (bOk && NewHeadCommit != OldHeadCommit)
+	{
+		// Only what the pull touched needs to be looked at again.
+		const FString RevRange = FString::Printf(TEXT("%s..%s"), *OldHeadCommit, *NewHeadCommit);
+		bOk = UeLfsUtils::GetChangedFiles(RepoRootPath, RevRange, ChangedFiles);
+
+		Provider.GetHistoryCache().Invalidate(ChangedFiles);
+	}
+
+	if (bOk)
+	{
+		bOk = Provider.GetOutdatedFiles().Refresh(RepoRootPath);
+	}
+
+	InCommand.bCommandSuccessful = bOk;
+	return InCommand.bCommandSuccessful;
+}
+
+//-----------------------------------------------------------------------------
+bool FUeLfsWorkerSync::UpdateStates() const
+{
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	FUeLfsProvider& Provider = UeLfs.GetProvider();
+	Provider.UpdateSyncedStates(ChangedFiles);
+	Provider.UpdateOutdatedStates();
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// "Unlock" worker impl.
+//-----------------------------------------------------------------------------
+
+FName FUeLfsWorkerUnlock::GetName() const
+{
+	return "Unlock";
+}
+
+//-----------------------------------------------------------------------------
+bool FUeLfsWorkerUnlock::Execute(FUeLfsCommand& InCommand)
+{
+	UELFS_TRACE_SCOPE(FUeLfsWorkerUnlock_Execute);
+
+	check(InCommand.Operation->GetName() == GetName());
+
+	InCommand.bCommandSuccessful = true;
+
+	if (InCommand.Files.Num() == 0)
+	{
+		return InCommand.bCommandSuccessful;
+	}
+
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	const FString& RepoRootPath = InCommand.RepositoryRoot;
+	FUeLfsHttp& AlHttp = UeLfs.GetHttp();
+
+	bool bOk = AlHttp.ReqUnlockFiles(*InCommand.Settings, RepoRootPath, UeLfsUtils::MakeUnlockItems(InCommand.Files, RepoRootPath), LockInfos);
+
+	InCommand.bCommandSuccessful = bOk;
+	return InCommand.bCommandSuccessful;
+}
+
+//-----------------------------------------------------------------------------
+bool FUeLfsWorkerUnlock::UpdateStates() const
+{
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	FUeLfsProvider& Provider = UeLfs.GetProvider();
+	Provider.UpdateLockedStates(LockInfos);
+	return true;
+}
+
+//-----------------------------------------------------------------------------
+// "PrefetchLockStates" worker impl.
+//-----------------------------------------------------------------------------
+
+FName FUeLfsWorkerPrefetchLockStates::GetName() const
+{
+	return "PrefetchLockStates";
+}
+
+//-----------------------------------------------------------------------------
+bool FUeLfsWorkerPrefetchLockStates::Execute(FUeLfsCommand& InCommand)
+{
+	UELFS_TRACE_SCOPE(FUeLfsWorkerPrefetchLockStates_Execute);
+
+	check(InCommand.Operation->GetName() == GetName());
+
+	InCommand.bCommandSuccessful = true;
+
+	// The user may have moved on while this waited for a thread.
+	TSharedRef<FUeLfsPrefetchLockStates, ESPMode::ThreadSafe> Operation =
+		StaticCastSharedRef<FUeLfsPrefetchLockStates>(InCommand.Operation);
+	if (InCommand.Files.Num() == 0 || Operation->IsCancelled())
+	{
+		return InCommand.bCommandSuccessful;
+	}
+
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	FUeLfsHttp& AlHttp = UeLfs.GetHttp();
+
+	InCommand.bCommandSuccessful = AlHttp.ReqGetLockStates(*InCommand.Settings, InCommand.RepositoryRoot, InCommand.Files, LockInfos);
+	return InCommand.bCommandSuccessful;
+}
+
+//-----------------------------------------------------------------------------
+bool FUeLfsWorkerPrefetchLockStates::UpdateStates() const
+{
+	if (LockInfos.Num() == 0)
+	{
+		return false;
+	}
+
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	FUeLfsProvider& Provider = UeLfs.GetProvider();
+	Provider.UpdateLockedStates(LockInfos);
 	return true;
 }
 
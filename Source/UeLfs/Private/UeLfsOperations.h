@@ -8,6 +8,75 @@
 #include "UeLfsState.h"
 #include "IUeLfsWorker.h"
 #include "UeLfsUtils.h"
+#include "ISourceControlOperation.h"
+
+/**
+ * Release locks without checking anything in.
+ */
+class FUeLfsUnlock : public ISourceControlOperation
+{
+public:
+	// ISourceControlOperation interface
+	virtual FName GetName() const override
+	{
+		return "Unlock";
+	}
+
+	virtual FText GetInProgressString() const override
+	{
+		return NSLOCTEXT("UeLfs", "SourceControl_Unlock", "Releasing lock(s)...");
+	}
+};
+
+/**
+ * Fetch the lock states of many files with one request, ahead of the editor asking for them.
+ * Cancellable until its request is sent.
+ */
+class FUeLfsPrefetchLockStates : public ISourceControlOperation
+{
+public:
+	// ISourceControlOperation interface
+	virtual FName GetName() const override
+	{
+		return "PrefetchLockStates";
+	}
+
+	virtual FText GetInProgressString() const override
+	{
+		return NSLOCTEXT("UeLfs", "SourceControl_PrefetchLockStates", "Fetching lock states...");
+	}
+
+	void Cancel()
+	{
+		bCancelled = true;
+	}
+
+	bool IsCancelled() const
+	{
+		return bCancelled;
+	}
+
+private:
+	FThreadSafeBool bCancelled;
+};
+
+/**
+ * Check files out with a single lock request, e.g. an asset together with its dependencies.
+ */
+class FUeLfsCheckOutBatch : public ISourceControlOperation
+{
+public:
+	// ISourceControlOperation interface
+	virtual FName GetName() const override
+	{
+		return "CheckOutBatch";
+	}
+
+	virtual FText GetInProgressString() const override
+	{
+		return NSLOCTEXT("UeLfs", "SourceControl_CheckOutBatch", "Checking file(s) out...");
+	}
+};
 
 //-----------------------------------------------------------------------------
 class FUeLfsWorkerConnect : public IUeLfsWorker
@@ -38,12 +107,18 @@ public:
 private:
 	TArray<FLfsLockInfo> LockInfos;
 	TArray<FString> AddedFiles;
+	TMap<FString, FUeLfsHistory> Histories;
 };
 
 //-----------------------------------------------------------------------------
 class FUeLfsWorkerCheckOut: public IUeLfsWorker
 {
 public:
+	FUeLfsWorkerCheckOut()
+		: bSingleRequest(false)
+	{
+	}
+
 	virtual ~FUeLfsWorkerCheckOut() {}
 
 	// IUeLfsWorker interface
@@ -51,15 +126,40 @@ public:
 	virtual bool Execute(class FUeLfsCommand& InCommand) override;
 	virtual bool UpdateStates() const override;
 
+protected:
+	/** Lock all files with one request, instead of pipelining them in chunks */
+	bool bSingleRequest;
+
 private:
 	TArray<FLfsLockInfo> LockInfos;
+	TArray<FLfsLockItem> LockItems;
 	TArray<FString> ModifiedFiles;
 };
 
+//-----------------------------------------------------------------------------
+class FUeLfsWorkerCheckOutBatch : public FUeLfsWorkerCheckOut
+{
+public:
+	FUeLfsWorkerCheckOutBatch()
+	{
+		bSingleRequest = true;
+	}
+
+	virtual ~FUeLfsWorkerCheckOutBatch() {}
+
+	// IUeLfsWorker interface
+	virtual FName GetName() const override;
+};
+
 //-----------------------------------------------------------------------------
 class FUeLfsWorkerCheckIn : public IUeLfsWorker
 {
 public:
+	FUeLfsWorkerCheckIn()
+		: bLocksReleased(false)
+	{
+	}
+
 	virtual ~FUeLfsWorkerCheckIn() {}
 
 	// IUeLfsWorker interface
@@ -68,7 +168,9 @@ public:
 	virtual bool UpdateStates() const override;
 
 private:
-	TArray<FLfsLockInfo> LockInfos;
+	TArray<FString> CheckedInFiles;
+	FString CommitHash;
+	bool bLocksReleased;
 };
 
 //-----------------------------------------------------------------------------
@@ -91,12 +193,22 @@ private:
 class FUeLfsWorkerRevert : public IUeLfsWorker
 {
 public:
+	FUeLfsWorkerRevert()
+		: bLocksReleased(false)
+	{
+	}
+
 	virtual ~FUeLfsWorkerRevert() {}
 
 	// IUeLfsWorker interface
 	virtual FName GetName() const override;
 	virtual bool Execute(class FUeLfsCommand& InCommand) override;
 	virtual bool UpdateStates() const override;
+
+private:
+	TArray<FString> RevertedFiles;
+	TArray<FString> UnstagedFiles;
+	bool bLocksReleased;
 };
 
 //-----------------------------------------------------------------------------
@@ -121,4 +233,52 @@ public:
 	virtual FName GetName() const override;
 	virtual bool Execute(class FUeLfsCommand& InCommand) override;
 	virtual bool UpdateStates() const override;
+
+private:
+	TArray<FString> AddedFiles;
+};
+
+//-----------------------------------------------------------------------------
+class FUeLfsWorkerSync : public IUeLfsWorker
+{
+public:
+	virtual ~FUeLfsWorkerSync() {}
+
+	// IUeLfsWorker interface
+	virtual FName GetName() const override;
+	virtual bool Execute(class FUeLfsCommand& InCommand) override;
+	virtual bool UpdateStates() const override;
+
+private:
+	TArray<FString> ChangedFiles;
+};
+
+//-----------------------------------------------------------------------------
+class FUeLfsWorkerUnlock : public IUeLfsWorker
+{
+public:
+	virtual ~FUeLfsWorkerUnlock() {}
+
+	// IUeLfsWorker interface
+	virtual FName GetName() const override;
+	virtual bool Execute(class FUeLfsCommand& InCommand) override;
+	virtual bool UpdateStates() const override;
+
+private:
+	TArray<FLfsLockInfo> LockInfos;
+};
+
+//-----------------------------------------------------------------------------
+class FUeLfsWorkerPrefetchLockStates : public IUeLfsWorker
+{
+public:
+	virtual ~FUeLfsWorkerPrefetchLockStates() {}
+
+	// IUeLfsWorker interface
+	virtual FName GetName() const override;
+	virtual bool Execute(class FUeLfsCommand& InCommand) override;
+	virtual bool UpdateStates() const override;
+
+private:
+	TArray<FLfsLockInfo> LockInfos;
 };
@@ -0,0 +1,92 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#include "UeLfsOutdatedFiles.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "ISourceControlModule.h"
+#include "UeLfsUtils.h"
+#include "UeLfsTrace.h"
+
+bool FUeLfsOutdatedFiles::Refresh(const FString& RepoRootPath)
+{
+	UELFS_TRACE_SCOPE(UeLfs_RefreshOutdatedFiles);
+
+	// One entry per repository, however its root is spelled.
+	FString RepoKey = RepoRootPath;
+	FPaths::NormalizeDirectoryName(RepoKey);
+
+	FString NewHeadCommit;
+	FString NewUpstreamCommit;
+	if (!UeLfsUtils::GetHeadAndUpstreamCommits(RepoRootPath, NewHeadCommit, NewUpstreamCommit))
+	{
+		return false;
+	}
+
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		const FRepoFiles* Known = RepoFiles.Find(RepoKey);
+		if (Known != nullptr && Known->HeadCommit == NewHeadCommit && Known->UpstreamCommit == NewUpstreamCommit)
+		{
+			return true;
+		}
+	}
+
+	// Without an upstream there is nothing to be behind of.
+	TArray<FString> ChangedFiles;
+	if (!NewUpstreamCommit.IsEmpty())
+	{
+		const FString RevRange = FString::Printf(TEXT("%s...%s"), *NewHeadCommit, *NewUpstreamCommit);
+		if (!UeLfsUtils::GetChangedFiles(RepoRootPath, RevRange, ChangedFiles))
+		{
+			return false;
+		}
+	}
+
+	UE_LOG(LogSourceControl, Log, TEXT("[UeLfs] %d file(s) changed upstream in %s (%s)."),
+		ChangedFiles.Num(), *RepoRootPath, *NewUpstreamCommit);
+
+	{
+		FScopeLock ScopeLock(&CriticalSection);
+		FRepoFiles& Repo = RepoFiles.FindOrAdd(RepoKey);
+		Repo.HeadCommit = NewHeadCommit;
+		Repo.UpstreamCommit = NewUpstreamCommit;
+		Repo.Files = TSet<FString>(ChangedFiles);
+		++Version;
+	}
+
+	return true;
+}
+
+bool FUeLfsOutdatedFiles::IsOutdated(const FString& FilePath) const
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	for (const TPair<FString, FRepoFiles>& Pair : RepoFiles)
+	{
+		if (Pair.Value.Files.Contains(FilePath))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+TSet<FString> FUeLfsOutdatedFiles::GetFiles(uint32& OutVersion) const
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	OutVersion = Version;
+
+	TSet<FString> Files;
+	for (const TPair<FString, FRepoFiles>& Pair : RepoFiles)
+	{
+		Files.Append(Pair.Value.Files);
+	}
+	return Files;
+}
+
+uint32 FUeLfsOutdatedFiles::GetVersion() const
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	return Version;
+}
@@ -0,0 +1,52 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Files changed on the upstream branch since HEAD forked from it (HEAD...upstream),
+ * read with one 'git diff' per repository and kept until its HEAD or upstream ref moves.
+ * Refreshed from worker threads, so all access is guarded.
+ */
+class FUeLfsOutdatedFiles
+{
+public:
+	FUeLfsOutdatedFiles()
+		: Version(0)
+	{
+	}
+
+	/**
+	 * Re-read the outdated files of the repository if its HEAD or upstream moved since the last refresh.
+	 * Costs one 'git rev-parse' when nothing moved.
+	 */
+	bool Refresh(const FString& RepoRootPath);
+
+	/** Is the file changed upstream? */
+	bool IsOutdated(const FString& FilePath) const;
+
+	/** Get the outdated files of all repositories and the version of the set. */
+	TSet<FString> GetFiles(uint32& OutVersion) const;
+
+	/** Get the version of the set, bumped every time it changes. */
+	uint32 GetVersion() const;
+
+private:
+	/** A critical section for cache access */
+	mutable FCriticalSection CriticalSection;
+
+	/** What one repository was refreshed from, and its outdated files */
+	struct FRepoFiles
+	{
+		FString HeadCommit;
+		FString UpstreamCommit;
+		TSet<FString> Files;
+	};
+
+	/** Outdated files by repository root */
+	TMap<FString, FRepoFiles> RepoFiles;
+	uint32 Version;
+};
@@ -0,0 +1,129 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#include "UeLfsPathTrie.h"
+#include "Misc/Paths.h"
+
+void FUeLfsPathTrie::Add(const FString& FilePath)
+{
+	TArray<FString> Components;
+	SplitPath(FilePath, Components);
+
+	FNode* Node = &Root;
+	for (const FString& Component : Components)
+	{
+		TUniquePtr<FNode>& Child = Node->Children.FindOrAdd(Component);
+		if (!Child.IsValid())
+		{
+			Child = MakeUnique<FNode>();
+		}
+		Node = Child.Get();
+	}
+
+	if (Node != &Root && Node->FilePath.IsEmpty())
+	{
+		Node->FilePath = FilePath;
+		++NumFiles;
+	}
+}
+
+void FUeLfsPathTrie::Reset()
+{
+	Root.Children.Reset();
+	NumFiles = 0;
+}
+
+void FUeLfsPathTrie::Find(const FString& PathPattern, TArray<FString>& OutFiles) const
+{
+	TArray<FString> Components;
+	SplitPath(PathPattern, Components);
+
+	// 'a/.../b' can reach a file along several routes; report each file once.
+	TSet<FString> Files;
+	Match(Root, Components, 0, false, Files);
+
+	OutFiles.Append(Files.Array());
+}
+
+void FUeLfsPathTrie::Match(const FNode& Node, const TArray<FString>& Components, int32 Index,
+	bool bLastWasWildcard, TSet<FString>& OutFiles) const
+{
+	if (Index == Components.Num())
+	{
+		// A wildcard names files; a plain path may name a directory.
+		if (bLastWasWildcard)
+		{
+			if (!Node.FilePath.IsEmpty())
+			{
+				OutFiles.Add(Node.FilePath);
+			}
+		}
+		else
+		{
+			CollectFiles(Node, OutFiles);
+		}
+		return;
+	}
+
+	const FString& Component = Components[Index];
+
+	if (Component == TEXT("..."))
+	{
+		if (Index + 1 == Components.Num())
+		{
+			CollectFiles(Node, OutFiles);
+			return;
+		}
+
+		// No directory, or one more and still inside the '...'.
+		Match(Node, Components, Index + 1, false, OutFiles);
+		for (const TPair<FString, TUniquePtr<FNode>>& Child : Node.Children)
+		{
+			Match(*Child.Value, Components, Index, false, OutFiles);
+		}
+		return;
+	}
+
+	int32 WildcardIndex = INDEX_NONE;
+	if (Component.FindChar(TEXT('*'), WildcardIndex) || Component.FindChar(TEXT('?'), WildcardIndex) ||
+		Component.Contains(TEXT("...")))
+	{
+		// Within a component, '...' can't cross directories; it is a '*'.
+		const FString Wildcard = Component.Replace(TEXT("..."), TEXT("*"));
+		for (const TPair<FString, TUniquePtr<FNode>>& Child : Node.Children)
+		{
+			if (Child.Key.MatchesWildcard(Wildcard))
+			{
+				Match(*Child.Value, Components, Index + 1, true, OutFiles);
+			}
+		}
+		return;
+	}
+
+	const TUniquePtr<FNode>* Child = Node.Children.Find(Component);
+	if (Child != nullptr)
+	{
+		Match(**Child, Components, Index + 1, false, OutFiles);
+	}
+}
+
+void FUeLfsPathTrie::CollectFiles(const FNode& Node, TSet<FString>& OutFiles) const
+{
+	if (!Node.FilePath.IsEmpty())
+	{
+		OutFiles.Add(Node.FilePath);
+	}
+
+	for (const TPair<FString, TUniquePtr<FNode>>& Child : Node.Children)
+	{
+		CollectFiles(*Child.Value, OutFiles);
+	}
+}
+
+void FUeLfsPathTrie::SplitPath(const FString& Path, TArray<FString>& OutComponents)
+{
+	FString NormalizedPath = Path;
+	FPaths::NormalizeFilename(NormalizedPath);
+	NormalizedPath.ParseIntoArray(OutComponents, TEXT("/"), true);
+}
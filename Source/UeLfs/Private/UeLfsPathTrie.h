@@ -0,0 +1,60 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+
+/**
+ * Known files by path component, so a directory or a wildcard path resolves to its files
+ * by walking only the matching branches.
+ * Game thread only.
+ */
+class FUeLfsPathTrie
+{
+public:
+	FUeLfsPathTrie()
+		: NumFiles(0)
+	{
+	}
+
+	/** Add a file (an absolute path). */
+	void Add(const FString& FilePath);
+
+	/** Forget all files. */
+	void Reset();
+
+	/** Get the number of files. */
+	int32 Num() const { return NumFiles; }
+
+	/**
+	 * Find the files matching a path:
+	 * a directory matches all files below it, '...' matches any number of directories
+	 * (all files below, at the end), and '*' and '?' match within one path component.
+	 */
+	void Find(const FString& PathPattern, TArray<FString>& OutFiles) const;
+
+private:
+	struct FNode
+	{
+		TMap<FString, TUniquePtr<FNode>> Children;
+
+		/** Set if a file ends here */
+		FString FilePath;
+	};
+
+	// Match the components from Index on, below the node.
+	void Match(const FNode& Node, const TArray<FString>& Components, int32 Index,
+		bool bLastWasWildcard, TSet<FString>& OutFiles) const;
+
+	// Collect all files at and below the node.
+	void CollectFiles(const FNode& Node, TSet<FString>& OutFiles) const;
+
+	static void SplitPath(const FString& Path, TArray<FString>& OutComponents);
+
+private:
+	FNode Root;
+	int32 NumFiles;
+};
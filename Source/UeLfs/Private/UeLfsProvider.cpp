@@ -5,57 +5,144 @@
 #include "UeLfsProvider.h"
 #include "Misc/MessageDialog.h"
 #include "Misc/QueuedThreadPool.h"
+#include "Misc/Paths.h"
+#include "HAL/FileManager.h"
 #include "Modules/ModuleManager.h"
 #include "ISourceControlModule.h"
 #include "UeLfsCommand.h"
+#include "UeLfsOperations.h"
 #include "UeLfsModule.h"
 #include "SourceControlHelpers.h"
 #include "SourceControlOperations.h"
 #include "UeLfsUtils.h"
+#include "UeLfsTrace.h"
 #include "SUeLfsSettings.h"
 #include "Logging/MessageLog.h"
 #include "ScopedSourceControlProgress.h"
+#include "Async/Async.h"
 
 #define LOCTEXT_NAMESPACE "UeLfs"
 
+TRACE_DECLARE_INT_COUNTER(UeLfs_QueuedCommands, TEXT("UeLfs/Commands/Queued"));
+
+namespace UeLfsProviderConstants
+{
+	/** Longest time a synchronous command waits before ticking http and the progress dialog again */
+	static const uint32 SynchronousTickIntervalMs = 10;
+}
+
+// Lock state of a file nobody has locked.
+static ELockState::Type GetUnlockedState(const FUeLfsState& State)
+{
+	return State.bIsCurrent ? ELockState::NotLocked : ELockState::NotCurrent;
+}
+
 void FUeLfsProvider::Init(bool bForceConnection)
 {
-	// Set git binary and repo root path if not set already.
 	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
-	const FString& GitBinaryPath = UeLfs.AccessSettings().GetGitBinaryPath();
-	if (GitBinaryPath.IsEmpty())
+	FUeLfsSettings& Settings = UeLfs.AccessSettings();
+
+	// Recommend the "default" asset locker server.
+	if (Settings.GetServerUrl().IsEmpty())
 	{
-		FString BinPath = UeLfsUtils::FindGitBinaryPath();
-		UeLfs.AccessSettings().SetGitBinaryPath(BinPath);
+		Settings.SetServerUrl(TEXT("http://localhost:15111"));
 	}
 
-	const FString& RepoRootPath = UeLfs.AccessSettings().GetRepoRootPath();
-	if (RepoRootPath.IsEmpty())
+	const FString ProjectDirAbs = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir());
+	const FString GitBinaryPath = Settings.GetGitBinaryPath();
+	const FString RepoRootPath = Settings.GetRepoRootPath();
+	const FString UserName = Settings.GetUserName();
+
+	// Nothing changed since the last launch; trust what is in the ini.
+	if (!GitBinaryPath.IsEmpty() && !RepoRootPath.IsEmpty() && !UserName.IsEmpty() &&
+		Settings.GetDiscoveryFingerprint() == UeLfsUtils::MakeDiscoveryFingerprint(ProjectDirAbs, RepoRootPath, GitBinaryPath))
 	{
-		FString RootPath;
-		FString ProjectDirAbs = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir());
-		UeLfsUtils::FindRepoRootPath(ProjectDirAbs, RootPath);
-		UeLfs.AccessSettings().SetRepoRootPath(RootPath);
+		return;
 	}
 
-	// Recommend the "default" asset locker server.
-	const FString& ServerUrl = UeLfs.AccessSettings().GetServerUrl();
-	if (ServerUrl.IsEmpty())
+	UELFS_TRACE_SCOPE(UeLfs_StartDiscovery);
+
+	// Set git binary and repo root path if not set (or no longer valid), each on its own task.
+	TArray<FString> GitBinaryPaths;
+	GitBinaryPath.ParseIntoArrayLines(GitBinaryPaths);
+	if (GitBinaryPaths.Num() == 0 || !FPaths::FileExists(GitBinaryPaths[0].TrimStartAndEnd()))
 	{
-		UeLfs.AccessSettings().SetServerUrl(TEXT("http://localhost:15111"));
+		GitBinaryPathFuture = Async(EAsyncExecution::ThreadPool, []()
+		{
+			return UeLfsUtils::FindGitBinaryPath();
+		});
+	}
+
+	const FString GitDirPath = RepoRootPath / TEXT(".git");
+	if (RepoRootPath.IsEmpty() || (!FPaths::DirectoryExists(GitDirPath) && !FPaths::FileExists(GitDirPath)))
+	{
+		RepoRootPathFuture = Async(EAsyncExecution::ThreadPool, [ProjectDirAbs]()
+		{
+			FString RootPath;
+			UeLfsUtils::FindRepoRootPath(ProjectDirAbs, RootPath);
+			return RootPath;
+		});
 	}
 
 	// User "git config user.name" by default.
-	const FString& UserName = UeLfs.AccessSettings().GetUserName();
 	if (UserName.IsEmpty())
 	{
-		FString GitUserName = UeLfsUtils::GetGitUserName();
-		UeLfs.AccessSettings().SetUserName(GitUserName);
+		UserNameFuture = Async(EAsyncExecution::ThreadPool, []()
+		{
+			return UeLfsUtils::GetGitUserName();
+		});
 	}
+
+	bDiscoveryPending = true;
+}
+
+void FUeLfsProvider::FinishDiscovery()
+{
+	if (!bDiscoveryPending)
+	{
+		return;
+	}
+
+	UELFS_TRACE_SCOPE(UeLfs_FinishDiscovery);
+
+	bDiscoveryPending = false;
+
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	FUeLfsSettings& Settings = UeLfs.AccessSettings();
+
+	if (GitBinaryPathFuture.IsValid())
+	{
+		Settings.SetGitBinaryPath(GitBinaryPathFuture.Get());
+		GitBinaryPathFuture = TFuture<FString>();
+	}
+
+	if (RepoRootPathFuture.IsValid())
+	{
+		Settings.SetRepoRootPath(RepoRootPathFuture.Get());
+		RepoRootPathFuture = TFuture<FString>();
+	}
+
+	if (UserNameFuture.IsValid())
+	{
+		Settings.SetUserName(UserNameFuture.Get());
+		UserNameFuture = TFuture<FString>();
+	}
+
+	const FString ProjectDirAbs = FPaths::ConvertRelativePathToFull(FPaths::ProjectDir());
+	Settings.SetDiscoveryFingerprint(UeLfsUtils::MakeDiscoveryFingerprint(ProjectDirAbs,
+		Settings.GetRepoRootPath(), Settings.GetGitBinaryPath()));
+
+	// Remember the results, so the next launch can skip discovery.
+	UeLfs.RequestSaveSettings();
 }
 
 void FUeLfsProvider::Close()
 {
+	// Repositories may come and go while disabled; find them again next time.
+	RepoResolver.Reset();
+	PathTrieIndexTimeStamps.Reset();
+	PendingPathTrieIndexTimeStamps.Reset();
+	PathTrieFuture = TFuture<TSharedPtr<FUeLfsPathTrie, ESPMode::ThreadSafe>>();
 }
 
 FText FUeLfsProvider::GetStatusText() const
@@ -103,6 +190,8 @@ ECommandResult::Type FUeLfsProvider::GetState(
 {
 	check(IsEnabled());
 
+	FinishDiscovery();
+
 	TArray<FString> AbsoluteFiles = SourceControlHelpers::AbsoluteFilenames(InFiles);
 	if (InStateCacheUsage == EStateCacheUsage::ForceUpdate)
 	{
@@ -142,23 +231,42 @@ ECommandResult::Type FUeLfsProvider::Execute(
 {
 	check(IsEnabled());
 
+	// Commands need the discovered settings.
+	FinishDiscovery();
+
 	UE_LOG(LogSourceControl, Warning, TEXT("[UeLfs-Exec]: %s (Async: %d, Files: %d)"),
 		*InOperation->GetName().ToString(),
 		(int32)InConcurrency,
 		InFiles.Num());
 
-	if (!UeLfsUtils::CheckFilenames(InFiles))
+	// Directories and wildcards become the files they cover, so workers only ever see files.
+	TArray<FString> AbsoluteFiles;
+	ExpandPaths(SourceControlHelpers::AbsoluteFilenames(InFiles), AbsoluteFiles);
+
+	// Bulk callers (folders, dependencies) hand in whatever they cover; work on the lockable part.
+	// Asked about every file the editor touches; not worth a warning each.
+	const int32 NumRequestedFiles = AbsoluteFiles.Num();
+	AbsoluteFiles.RemoveAll([this](const FString& File)
 	{
-		InOperation->AddErrorMessge(LOCTEXT("UnsupportedFile", "Filename with wildcards is not supported by UeLfs"));
+		if (IsLockable(File))
+		{
+			return false;
+		}
+
+		UE_LOG(LogSourceControl, Verbose,
+			TEXT("File '%s' is not lockable in this repository"), *File);
+		return true;
+	});
+
+	if (NumRequestedFiles > 0 && AbsoluteFiles.Num() == 0)
+	{
+		InOperation->AddErrorMessge(LOCTEXT("UnsupportedFile", "Files that are not lockable are not supported by UeLfs"));
 		InOperationCompleteDelegate.ExecuteIfBound(InOperation, ECommandResult::Failed);
 		return ECommandResult::Failed;
 	}
 
-	TArray<FString> AbsoluteFiles = SourceControlHelpers::AbsoluteFilenames(InFiles);
-
 	// Query to see if the we allow this operation
-	TSharedPtr<IUeLfsWorker, ESPMode::ThreadSafe> Worker = CreateWorker(InOperation->GetName());
-	if (!Worker.IsValid())
+	if (!WorkersMap.Contains(InOperation->GetName()))
 	{
 		// This operation is unsupported by this source control provider
 		FFormatNamedArguments Arguments;
@@ -174,29 +282,260 @@ ECommandResult::Type FUeLfsProvider::Execute(
 	// Fire off operation.
 	if (InConcurrency == EConcurrency::Synchronous)
 	{
-		FUeLfsCommand* Command = new FUeLfsCommand(InOperation, Worker.ToSharedRef());
-		Command->bAutoDelete = false;
-		Command->Files = AbsoluteFiles;
-		Command->OperationCompleteDelegate = InOperationCompleteDelegate;
-		return ExecuteSynchronousCommand(*Command, InOperation->GetInProgressString(), true);
+		TArray<FUeLfsCommand*> Commands;
+		CreateRepoCommands(InOperation, AbsoluteFiles, Commands);
+
+		if (Commands.Num() == 1)
+		{
+			Commands[0]->OperationCompleteDelegate = InOperationCompleteDelegate;
+		}
+		else
+		{
+			FUeLfsCommandJoinRef Join = MakeShared<FUeLfsCommandJoin, ESPMode::ThreadSafe>(
+				InOperation, InOperationCompleteDelegate, Commands.Num());
+			for (FUeLfsCommand* Command : Commands)
+			{
+				Command->Joins.Add(Join);
+			}
+		}
+
+		for (FUeLfsCommand* Command : Commands)
+		{
+			Command->bAutoDelete = false;
+		}
+		return ExecuteSynchronousCommands(Commands, InOperation->GetInProgressString(), true);
 	}
 	else
 	{
-		FUeLfsCommand* Command = new FUeLfsCommand(InOperation, Worker.ToSharedRef());
-		Command->bAutoDelete = true;
-		Command->Files = AbsoluteFiles;
-		Command->OperationCompleteDelegate = InOperationCompleteDelegate;
-		return IssueCommand(*Command, false);
+		// Attach to any in-flight work that already covers the requested files.
+		TArray<FString> RemainingFiles = AbsoluteFiles;
+		TArray<FUeLfsCommand*> CoveringCommands;
+		FindCoveringCommands(*InOperation, RemainingFiles, CoveringCommands);
+
+		TArray<FUeLfsCommand*> Commands;
+		if (CoveringCommands.Num() == 0 || RemainingFiles.Num() > 0)
+		{
+			CreateRepoCommands(InOperation, RemainingFiles, Commands);
+		}
+
+		if (CoveringCommands.Num() == 0 && Commands.Num() == 1)
+		{
+			Commands[0]->bAutoDelete = true;
+			Commands[0]->OperationCompleteDelegate = InOperationCompleteDelegate;
+			return IssueCommand(*Commands[0], false);
+		}
+
+		// The join runs the caller's delegate once every part has completed.
+		FUeLfsCommandJoinRef Join = MakeShared<FUeLfsCommandJoin, ESPMode::ThreadSafe>(
+			InOperation, InOperationCompleteDelegate, CoveringCommands.Num() + Commands.Num());
+
+		for (FUeLfsCommand* CoveringCommand : CoveringCommands)
+		{
+			CoveringCommand->Joins.Add(Join);
+		}
+
+		UE_LOG(LogSourceControl, Verbose, TEXT("[UeLfs-Exec]: %s joined %d in-flight command(s), %d file(s) remaining in %d repositories"),
+			*InOperation->GetName().ToString(),
+			CoveringCommands.Num(),
+			RemainingFiles.Num(),
+			Commands.Num());
+
+		for (FUeLfsCommand* Command : Commands)
+		{
+			Command->bAutoDelete = true;
+			Command->Joins.Add(Join);
+			IssueCommand(*Command, false);
+		}
+
+		return ECommandResult::Succeeded;
+	}
+}
+
+void FUeLfsProvider::CreateRepoCommands(const TSharedRef<ISourceControlOperation, ESPMode::ThreadSafe>& InOperation,
+	const TArray<FString>& InFiles,
+	TArray<FUeLfsCommand*>& OutCommands)
+{
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	const FString DefaultRootPath = UeLfs.AccessSettings().GetRepoRootPath();
+
+	// Each repository has its own branch and lock server; its files go in a request of their own.
+	TMap<FString, TArray<FString>> FilesByRepo;
+	for (const FString& File : InFiles)
+	{
+		FilesByRepo.FindOrAdd(RepoResolver.Resolve(File, DefaultRootPath)->RootPath).Add(File);
+	}
+
+	if (FilesByRepo.Num() == 0)
+	{
+		FilesByRepo.Add(RepoResolver.Resolve(DefaultRootPath, DefaultRootPath)->RootPath);
+	}
+
+	for (TPair<FString, TArray<FString>>& Pair : FilesByRepo)
+	{
+		// Workers keep their results, so every command needs its own.
+		FUeLfsCommand* Command = new FUeLfsCommand(InOperation, CreateWorker(InOperation->GetName()).ToSharedRef());
+		Command->RepositoryRoot = Pair.Key;
+		Command->Files = MoveTemp(Pair.Value);
+		OutCommands.Add(Command);
 	}
 }
 
 bool FUeLfsProvider::CanCancelOperation( const TSharedRef<ISourceControlOperation, ESPMode::ThreadSafe>& InOperation ) const
 {
-	return false;
+	// Prefetches only read; dropping one loses nothing.
+	return InOperation->GetName() == "PrefetchLockStates";
 }
 
 void FUeLfsProvider::CancelOperation( const TSharedRef<ISourceControlOperation, ESPMode::ThreadSafe>& InOperation )
 {
+	if (CanCancelOperation(InOperation))
+	{
+		StaticCastSharedRef<FUeLfsPrefetchLockStates>(InOperation)->Cancel();
+	}
+}
+
+void FUeLfsProvider::ExpandPaths(const TArray<FString>& InPaths, TArray<FString>& OutFiles)
+{
+	for (const FString& Path : InPaths)
+	{
+		// Directories come with a trailing separator; no need to ask the disk about every file.
+		if (!UeLfsUtils::HasWildcards(Path) && !Path.EndsWith(TEXT("/")) && !Path.EndsWith(TEXT("\\")))
+		{
+			OutFiles.Add(Path);
+			continue;
+		}
+
+		UELFS_TRACE_SCOPE(UeLfs_ExpandPath);
+
+		// The repository the path points into must be known for its files to be in the trie.
+		ResolveRepo(Path);
+		RefreshPathTrie();
+		FinishPathTrie(true);
+
+		// Only what can be locked; a directory holds all kinds of files.
+		TArray<FString> MatchedFiles;
+		PathTrie.Find(Path, MatchedFiles);
+		for (FString& File : MatchedFiles)
+		{
+			if (IsLockable(File))
+			{
+				OutFiles.Add(MoveTemp(File));
+			}
+		}
+	}
+}
+
+void FUeLfsProvider::RefreshPathTrie()
+{
+	// The configured repository is always in the trie, found or not.
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	ResolveRepo(UeLfs.AccessSettings().GetRepoRootPath());
+
+	TArray<FUeLfsRepoInfoRef> Repos;
+	RepoResolver.GetRepos(Repos);
+
+	if (PathTrieFuture.IsValid())
+	{
+		// One build at a time; the running one will do unless repositories were found since it started.
+		if (Repos.Num() == PendingPathTrieIndexTimeStamps.Num())
+		{
+			return;
+		}
+
+		PathTrieFuture.Wait();
+		FinishPathTrie(false);
+	}
+
+	// Adds, removals, commits and pulls all rewrite the index.
+	TMap<FString, FDateTime> IndexTimeStamps;
+	TArray<FString> RepoRootPaths;
+	for (const FUeLfsRepoInfoRef& Repo : Repos)
+	{
+		IndexTimeStamps.Add(Repo->RootPath, IFileManager::Get().GetTimeStamp(*(Repo->GitDirPath / TEXT("index"))));
+		RepoRootPaths.Add(Repo->RootPath);
+	}
+
+	if (IndexTimeStamps.OrderIndependentCompareEqual(PathTrieIndexTimeStamps))
+	{
+		return;
+	}
+
+	PendingPathTrieIndexTimeStamps = MoveTemp(IndexTimeStamps);
+
+	// Listing the tracked files runs git; keep that off the game thread.
+	PathTrieFuture = Async(EAsyncExecution::ThreadPool, [RepoRootPaths]()
+	{
+		UELFS_TRACE_SCOPE(UeLfs_BuildPathTrie);
+
+		TSharedPtr<FUeLfsPathTrie, ESPMode::ThreadSafe> Trie = MakeShared<FUeLfsPathTrie, ESPMode::ThreadSafe>();
+
+		// A repository does not list the files of its submodules; each lists its own.
+		for (const FString& RepoRootPath : RepoRootPaths)
+		{
+			TArray<FString> TrackedFiles;
+			UeLfsUtils::ListTrackedFiles(RepoRootPath, TrackedFiles);
+			for (const FString& File : TrackedFiles)
+			{
+				Trie->Add(File);
+			}
+		}
+
+		return Trie;
+	});
+}
+
+void FUeLfsProvider::FinishPathTrie(bool bWaitForNewRepos)
+{
+	if (!PathTrieFuture.IsValid())
+	{
+		return;
+	}
+
+	// The trie in use is good enough until the new one is ready, unless it lacks whole repositories.
+	bool bWait = false;
+	if (bWaitForNewRepos)
+	{
+		for (const TPair<FString, FDateTime>& Pair : PendingPathTrieIndexTimeStamps)
+		{
+			bWait |= !PathTrieIndexTimeStamps.Contains(Pair.Key);
+		}
+	}
+
+	if (!bWait && !PathTrieFuture.IsReady())
+	{
+		return;
+	}
+
+	TSharedPtr<FUeLfsPathTrie, ESPMode::ThreadSafe> Trie = PathTrieFuture.Get();
+	PathTrieFuture = TFuture<TSharedPtr<FUeLfsPathTrie, ESPMode::ThreadSafe>>();
+
+	PathTrie = MoveTemp(*Trie);
+	PathTrieIndexTimeStamps = MoveTemp(PendingPathTrieIndexTimeStamps);
+	PendingPathTrieIndexTimeStamps.Reset();
+
+	// Files known to the editor but not (yet) to git, e.g. new assets.
+	for (const TPair<FString, TSharedRef<FUeLfsState, ESPMode::ThreadSafe>>& Pair : StateCache)
+	{
+		PathTrie.Add(Pair.Key);
+	}
+}
+
+bool FUeLfsProvider::IsLockable(const FString& FilePath)
+{
+	return LockableMatcher.IsLockable(FilePath, ResolveRepo(FilePath)->RootPath);
+}
+
+FUeLfsRepoInfoRef FUeLfsProvider::ResolveRepo(const FString& FilePath)
+{
+	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
+	return RepoResolver.Resolve(FilePath, UeLfs.AccessSettings().GetRepoRootPath());
+}
+
+bool FUeLfsProvider::HasKnownLockState(const FString& FilePath) const
+{
+	// GetState() caches a placeholder for every file it is asked about; that knows nothing yet.
+	const TSharedRef<FUeLfsState, ESPMode::ThreadSafe>* State = StateCache.Find(FilePath);
+	return State != nullptr && (*State)->LockState != ELockState::Unknown;
 }
 
 bool FUeLfsProvider::UsesLocalReadOnlyState() const
@@ -216,6 +555,20 @@ bool FUeLfsProvider::UsesCheckout() const
 
 void FUeLfsProvider::Tick()
 {
+	UELFS_TRACE_SCOPE(UeLfs_Tick);
+	TRACE_COUNTER_SET(UeLfs_QueuedCommands, CommandQueue.Num());
+
+	// Apply discovery as soon as it is done, without waiting for it.
+	if (bDiscoveryPending &&
+		(!GitBinaryPathFuture.IsValid() || GitBinaryPathFuture.IsReady()) &&
+		(!RepoRootPathFuture.IsValid() || RepoRootPathFuture.IsReady()) &&
+		(!UserNameFuture.IsValid() || UserNameFuture.IsReady()))
+	{
+		FinishDiscovery();
+	}
+
+	FinishPathTrie(false);
+
 	bool bStatesUpdated = false;
 	for (int32 CommandIndex = 0; CommandIndex < CommandQueue.Num(); ++CommandIndex)
 	{
@@ -266,7 +619,7 @@ TSharedRef<class SWidget> FUeLfsProvider::MakeSettingsWidget() const
 #endif // SOURCE_CONTROL_WITH_SLATE
 
 
-const FString& FUeLfsProvider::GetUserName() const
+FString FUeLfsProvider::GetUserName() const
 {
 	FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
 	return UeLfs.AccessSettings().GetUserName();
@@ -280,26 +633,26 @@ void FUeLfsProvider::RegisterWorker(const FName& InName, const FGetUeLfsWorker&
 
 void FUeLfsProvider::UpdateLockedStates(const TArray<FLfsLockInfo>& LockInfos)
 {
+	// Connect may pass the whole lock table; look the user up once.
+	const FString MyUserName = GetUserName();
+
 	for (const FLfsLockInfo& Ali : LockInfos)
 	{
 		TSharedRef<FUeLfsState, ESPMode::ThreadSafe> State = GetSingleState(Ali.FilePath);
 
 		State->LockUser = Ali.LockUserName;
 
-		if (GetUserName() == Ali.LockUserName)
+		if (Ali.LockUserName.IsEmpty())
+		{
+			State->LockState = GetUnlockedState(*State);
+		}
+		else if (MyUserName == Ali.LockUserName)
 		{
 			State->LockState = ELockState::Locked;
 		}
 		else
 		{
-			if (Ali.LockUserName.IsEmpty())
-			{
-				State->LockState = ELockState::NotLocked;
-			}
-			else
-			{
-				State->LockState = ELockState::LockedOther;
-			}
+			State->LockState = ELockState::LockedOther;
 		}
 	}
 }
@@ -308,7 +661,7 @@ void FUeLfsProvider::UpdateAddedStates(const TArray<FString>& AddedFiles)
 {
 	for (const FString& FilePath : AddedFiles)
 	{
-		UE_LOG(LogSourceControl, Warning, TEXT("[UeLfs] Update added file: %s"),
+		UE_LOG(LogSourceControl, Verbose, TEXT("[UeLfs] Update added file: %s"),
 			*FilePath);
 
 		TSharedRef<FUeLfsState, ESPMode::ThreadSafe> State = GetSingleState(FilePath);
@@ -320,7 +673,7 @@ void FUeLfsProvider::UpdateDeletedFiles(const TArray<FString>& DeletedFiles)
 {
 	for (const FString& FilePath : DeletedFiles)
 	{
-		UE_LOG(LogSourceControl, Warning, TEXT("[UeLfs] Update deleted file: %s"),
+		UE_LOG(LogSourceControl, Verbose, TEXT("[UeLfs] Update deleted file: %s"),
 			*FilePath);
 
 		TSharedRef<FUeLfsState, ESPMode::ThreadSafe> State = GetSingleState(FilePath);
@@ -332,7 +685,7 @@ void FUeLfsProvider::UpdateModifiedStates(const TArray<FString>& ModifiedFiles)
 {
 	for (const FString& FilePath : ModifiedFiles)
 	{
-		UE_LOG(LogSourceControl, Warning, TEXT("[UeLfs] Update modified file: %s"),
+		UE_LOG(LogSourceControl, Verbose, TEXT("[UeLfs] Update modified file: %s"),
 			*FilePath);
 
 		TSharedRef<FUeLfsState, ESPMode::ThreadSafe> State = GetSingleState(FilePath);
@@ -340,6 +693,108 @@ void FUeLfsProvider::UpdateModifiedStates(const TArray<FString>& ModifiedFiles)
 	}
 }
 
+void FUeLfsProvider::UpdateRevertedStates(const TArray<FString>& RevertedFiles,
+	const TArray<FString>& UnstagedFiles,
+	bool bLocksReleased)
+{
+	auto UpdateState = [this, bLocksReleased](const FString& FilePath, EWorkingCopyState::Type WorkingCopyState)
+	{
+		TSharedRef<FUeLfsState, ESPMode::ThreadSafe> State = GetSingleState(FilePath);
+		State->WorkingCopyState = WorkingCopyState;
+
+		if (bLocksReleased)
+		{
+			State->LockUser.Empty();
+			State->LockState = GetUnlockedState(*State);
+		}
+	};
+
+	for (const FString& FilePath : RevertedFiles)
+	{
+		UpdateState(FilePath, EWorkingCopyState::Unchanged);
+	}
+
+	// Files that are not in HEAD stay on disk as newly added files.
+	for (const FString& FilePath : UnstagedFiles)
+	{
+		UpdateState(FilePath, EWorkingCopyState::Added);
+	}
+}
+
+void FUeLfsProvider::UpdateCheckedInStates(const TArray<FString>& CheckedInFiles,
+	const FString& CommitHash,
+	bool bLocksReleased)
+{
+	for (const FString& FilePath : CheckedInFiles)
+	{
+		TSharedRef<FUeLfsState, ESPMode::ThreadSafe> State = GetSingleState(FilePath);
+
+		if (!CommitHash.IsEmpty())
+		{
+			State->WorkingCopyState = State->WorkingCopyState == EWorkingCopyState::Deleted
+				? EWorkingCopyState::NotControlled
+				: EWorkingCopyState::Unchanged;
+			State->LastCommitHash = CommitHash;
+		}
+
+		if (bLocksReleased)
+		{
+			State->LockUser.Empty();
+			State->LockState = GetUnlockedState(*State);
+		}
+	}
+}
+
+void FUeLfsProvider::UpdateSyncedStates(const TArray<FString>& ChangedFiles)
+{
+	for (const FString& FilePath : ChangedFiles)
+	{
+		TSharedRef<FUeLfsState, ESPMode::ThreadSafe>* Found = StateCache.Find(FilePath);
+		if (Found == nullptr)
+		{
+			continue;
+		}
+
+		// A fast-forward leaves changed files clean; anything derived from the old HEAD goes.
+		TSharedRef<FUeLfsState, ESPMode::ThreadSafe> State = *Found;
+		State->WorkingCopyState = FPaths::FileExists(FilePath)
+			? EWorkingCopyState::Unchanged
+			: EWorkingCopyState::NotControlled;
+		State->LastCommitHash.Empty();
+		State->History.Empty();
+	}
+}
+
+void FUeLfsProvider::UpdateHistories(const TMap<FString, FUeLfsHistory>& Histories)
+{
+	for (const auto& Elem : Histories)
+	{
+		TSharedRef<FUeLfsState, ESPMode::ThreadSafe> State = GetSingleState(Elem.Key);
+		State->History = Elem.Value;
+	}
+}
+
+void FUeLfsProvider::UpdateOutdatedStates()
+{
+	if (OutdatedFiles.GetVersion() == AppliedOutdatedVersion)
+	{
+		return;
+	}
+
+	// One pass over the whole cache, since files also become current again.
+	const TSet<FString> Files = OutdatedFiles.GetFiles(AppliedOutdatedVersion);
+	for (const auto& Elem : StateCache)
+	{
+		TSharedRef<FUeLfsState, ESPMode::ThreadSafe> State = Elem.Value;
+		State->bIsCurrent = !Files.Contains(Elem.Key);
+
+		if (State->LockState == ELockState::NotLocked || State->LockState == ELockState::NotCurrent)
+		{
+			State->LockState = GetUnlockedState(*State);
+		}
+	}
+}
+
 void FUeLfsProvider::ReleaseAllMyLocks(const FString& MyUserName)
 {
 	for (const auto& Elem : StateCache)
@@ -348,11 +803,20 @@ void FUeLfsProvider::ReleaseAllMyLocks(const FString& MyUserName)
 		if (State->LockUser == MyUserName)
 		{
 			State->LockUser.Empty();
-			State->LockState = ELockState::NotLocked;
+			State->LockState = GetUnlockedState(*State);
 		}
 	}
 }
 
+void FUeLfsProvider::UpdateLastCommitHashes(const TArray<FLfsLockItem>& LockItems)
+{
+	for (const FLfsLockItem& Item : LockItems)
+	{
+		TSharedRef<FUeLfsState, ESPMode::ThreadSafe> State = GetSingleState(Item.LocalFilePath);
+		State->LastCommitHash = Item.LastHash;
+	}
+}
+
 TArray<FLfsLockItem> FUeLfsProvider::MakeLockItems(const FString& RepoRootPath,
 	const TArray<FString>& FilePaths)
 {
@@ -407,8 +871,8 @@ TSharedPtr<class IUeLfsWorker, ESPMode::ThreadSafe> FUeLfsProvider::CreateWorker
 	return NULL;
 }
 
-ECommandResult::Type FUeLfsProvider::ExecuteSynchronousCommand(
-	class FUeLfsCommand& InCommand,
+ECommandResult::Type FUeLfsProvider::ExecuteSynchronousCommands(
+	const TArray<FUeLfsCommand*>& InCommands,
 	const FText& Task,
 	bool bSuppressResponseMsg)
 {
@@ -418,12 +882,24 @@ ECommandResult::Type FUeLfsProvider::ExecuteSynchronousCommand(
 	{
 		FScopedSourceControlProgress Progress(Task);
 
-		// Perform the command asynchronously
-		IssueCommand(InCommand, false);
+		// Perform the commands asynchronously, side by side
+		for (FUeLfsCommand* Command : InCommands)
+		{
+			IssueCommand(*Command, false);
+		}
 
 		double LastTime = FPlatformTime::Seconds();
-		while (!InCommand.bExecuteProcessed)
+		for (;;)
 		{
+			FUeLfsCommand* const* PendingCommand = InCommands.FindByPredicate([](const FUeLfsCommand* Command)
+			{
+				return !Command->bExecuteProcessed;
+			});
+			if (PendingCommand == nullptr)
+			{
+				break;
+			}
+
 			const double AppTime = FPlatformTime::Seconds();
 			UeLfsUtils::TickHttp(AppTime - LastTime);
 			LastTime = AppTime;
@@ -433,14 +909,34 @@ ECommandResult::Type FUeLfsProvider::ExecuteSynchronousCommand(
 
 			Progress.Tick();
 
-			// Sleep for a bit so we don't busy-wait so much.
-			FPlatformProcess::Sleep(0.01f);
+			// Wait for a worker to signal completion, waking up periodically
+			// only to keep http and the progress dialog going.
+			(*PendingCommand)->CompletionEvent->Wait(UeLfsProviderConstants::SynchronousTickIntervalMs);
+		}
+
+		// Tick() finishes only one command per call, and maybe an unrelated one;
+		// finish the rest of ours here, so none is deleted without its results.
+		bool bStatesUpdated = false;
+		for (FUeLfsCommand* Command : InCommands)
+		{
+			if (CommandQueue.Remove(Command) > 0)
+			{
+				bStatesUpdated |= Command->Worker->UpdateStates();
+				OutputCommandMessages(*Command);
+				Command->ReturnResults();
+			}
 		}
 
-		// always do one more Tick() to make sure the command queue is cleaned up.
-		Tick();
+		if (bStatesUpdated)
+		{
+			OnSourceControlStateChanged.Broadcast();
+		}
 
-		if (InCommand.bCommandSuccessful)
+		const bool bAllSuccessful = !InCommands.ContainsByPredicate([](const FUeLfsCommand* Command)
+		{
+			return !Command->bCommandSuccessful;
+		});
+		if (bAllSuccessful)
 		{
 			Result = ECommandResult::Succeeded;
 		}
@@ -453,16 +949,14 @@ ECommandResult::Type FUeLfsProvider::ExecuteSynchronousCommand(
 		FMessageDialog::Open(EAppMsgType::Ok, LOCTEXT("UeLfs_ServerUnresponsive", "UeLfs server is not responding. Please check your connection and try again."));
 	}
 
-	// Delete the command now
-	check(!InCommand.bAutoDelete);
-
-	// ensure commands that are not auto deleted do not end up in the command queue
-	if (CommandQueue.Contains(&InCommand))
+	// Delete the commands now
+	for (FUeLfsCommand* Command : InCommands)
 	{
-		CommandQueue.Remove(&InCommand);
-	}
+		check(!Command->bAutoDelete);
+		check(!CommandQueue.Contains(Command));
 
-	delete &InCommand;
+		delete Command;
+	}
 
 	return Result;
 }
@@ -488,6 +982,53 @@ ECommandResult::Type FUeLfsProvider::IssueCommand(class FUeLfsCommand& InCommand
 	}
 }
 
+void FUeLfsProvider::FindCoveringCommands(const ISourceControlOperation& InOperation,
+	TArray<FString>& InOutFiles,
+	TArray<FUeLfsCommand*>& OutCommands) const
+{
+	// Only status queries are free of side effects, so only they can be shared.
+	if (InOperation.GetName() != TEXT("UpdateStatus"))
+	{
+		return;
+	}
+
+	const FUpdateStatus& UpdateStatus = static_cast<const FUpdateStatus&>(InOperation);
+
+	for (FUeLfsCommand* Command : CommandQueue)
+	{
+		if (InOutFiles.Num() == 0)
+		{
+			break;
+		}
+
+		if (Command->Operation->GetName() != InOperation.GetName())
+		{
+			continue;
+		}
+
+		// The in-flight query must gather at least what this one asks for.
+		const FUpdateStatus& Other = static_cast<const FUpdateStatus&>(Command->Operation.Get());
+		if (Other.ShouldUpdateHistory() != UpdateStatus.ShouldUpdateHistory() ||
+			Other.ShouldGetOpenedOnly() != UpdateStatus.ShouldGetOpenedOnly() ||
+			Other.ShouldUpdateModifiedState() != UpdateStatus.ShouldUpdateModifiedState())
+		{
+			continue;
+		}
+
+		const TSet<FString> CommandFiles(Command->Files);
+		const int32 NumFiles = InOutFiles.Num();
+		InOutFiles.RemoveAll([&CommandFiles](const FString& File)
+		{
+			return CommandFiles.Contains(File);
+		});
+
+		if (InOutFiles.Num() != NumFiles)
+		{
+			OutCommands.Add(Command);
+		}
+	}
+}
+
 void FUeLfsProvider::OutputCommandMessages(const class FUeLfsCommand& InCommand) const
 {
 	FMessageLog SourceControlLog("SourceControl");
@@ -516,11 +1057,10 @@ TSharedRef<FUeLfsState, ESPMode::ThreadSafe> FUeLfsProvider::GetSingleState(
 	TSharedRef<FUeLfsState, ESPMode::ThreadSafe> NewState =
 		MakeShareable(new FUeLfsState(FilePath));
 
-	if (UeLfsUtils::CheckFilename(FilePath))
+	const FString RepoRootPath = ResolveRepo(FilePath)->RootPath;
+	if (LockableMatcher.IsLockable(FilePath, RepoRootPath))
 	{
-		// Set git path.
-		FUeLfsModule& UeLfs = FModuleManager::GetModuleChecked<FUeLfsModule>("UeLfs");
-		const FString& RepoRootPath = UeLfs.AccessSettings().GetRepoRootPath();
+		// Set git path, relative to the repository owning the file.
 		NewState->GitFilePath = FilePath;
 		FPaths::MakePathRelativeTo(NewState->GitFilePath, *RepoRootPath);
 
@@ -532,7 +1072,10 @@ TSharedRef<FUeLfsState, ESPMode::ThreadSafe> FUeLfsProvider::GetSingleState(
 		NewState->WorkingCopyState = EWorkingCopyState::NotControlled;
 	}
 
+	NewState->bIsCurrent = !OutdatedFiles.IsOutdated(FilePath);
+
 	StateCache.Add(FilePath, NewState);
+	PathTrie.Add(FilePath);
 
 	return NewState;
 }
@@ -11,6 +11,13 @@
 #include "ISourceControlProvider.h"
 #include "IUeLfsWorker.h"
 #include "UeLfsUtils.h"
+#include "UeLfsHistory.h"
+#include "UeLfsBlobCache.h"
+#include "UeLfsOutdatedFiles.h"
+#include "UeLfsLockableMatcher.h"
+#include "UeLfsPathTrie.h"
+#include "UeLfsRepoResolver.h"
+#include "Async/Future.h"
 
 DECLARE_DELEGATE_RetVal(FUeLfsWorkerRef, FGetUeLfsWorker)
 
@@ -19,6 +26,8 @@ class FUeLfsProvider : public ISourceControlProvider
 public:
 	/** Constructor */
 	FUeLfsProvider()
+		: bDiscoveryPending(false)
+		, AppliedOutdatedVersion(0)
 	{
 	}
 
@@ -53,7 +62,7 @@ public:
 	virtual TSharedRef<class SWidget> MakeSettingsWidget() const override;
 #endif
 
-	const FString& GetUserName() const;
+	FString GetUserName() const;
 
 	/**
 	 * Register a worker with the provider.
@@ -73,23 +82,72 @@ public:
 	// Update modified states.
 	void UpdateModifiedStates(const TArray<FString>& ModifiedFiles);
 
+	// Update reverted states, including the lock state if the locks were released.
+	void UpdateRevertedStates(const TArray<FString>& RevertedFiles,
+		const TArray<FString>& UnstagedFiles,
+		bool bLocksReleased);
+
+	// Update states of checked in files: unchanged at the new commit, and unlocked if the locks were released.
+	void UpdateCheckedInStates(const TArray<FString>& CheckedInFiles,
+		const FString& CommitHash,
+		bool bLocksReleased);
+
+	// Update states of files changed by a pull; files not in the cache are left alone.
+	void UpdateSyncedStates(const TArray<FString>& ChangedFiles);
+
+	// Update file histories.
+	void UpdateHistories(const TMap<FString, FUeLfsHistory>& Histories);
+
+	// Access the file history cache. (thread safe)
+	FUeLfsHistoryCache& GetHistoryCache() { return HistoryCache; }
+
+	// Access the exported file content cache. (thread safe)
+	FUeLfsBlobCache& GetBlobCache() { return BlobCache; }
+
+	// Access the files changed upstream. (thread safe)
+	FUeLfsOutdatedFiles& GetOutdatedFiles() { return OutdatedFiles; }
+
+	// Access the repositories found so far. (thread safe)
+	FUeLfsRepoResolver& GetRepoResolver() { return RepoResolver; }
+
+	// Get the repository owning a file; the configured repository if none does. (thread safe)
+	FUeLfsRepoInfoRef ResolveRepo(const FString& FilePath);
+
+	// Mark states changed upstream as not current, if the outdated files changed since last time.
+	void UpdateOutdatedStates();
+
 	// Release all "my" locks.
 	void ReleaseAllMyLocks(const FString& MyUserName);
 
+	// Remember last commit hashes resolved for lock items.
+	void UpdateLastCommitHashes(const TArray<FLfsLockItem>& LockItems);
+
 	// Build FLfsLockItem array from file path string array.
 	TArray<FLfsLockItem> MakeLockItems(const FString& RepoRootPath, const TArray<FString>& FilePaths);
 
+	// Is the file lockable, according to the repository's .gitattributes? (thread safe)
+	bool IsLockable(const FString& FilePath);
+
+	// Is the lock state of the file known, from a query or from the lock table? (game thread only)
+	bool HasKnownLockState(const FString& FilePath) const;
+
+	// Start rebuilding the path trie in the background if an index changed since it was built. (game thread only)
+	void RefreshPathTrie();
+
 	// Get files locked by 'UserName'.
 	void GetLockedFiles(TArray<FLfsLockItem>& OutLockItems, const FString& UserName);
 
 private:
 
+	// Apply settings discovered in the background, waiting for them if needed.
+	void FinishDiscovery();
+
 	// Helper function for Execute().
 	TSharedPtr<class IUeLfsWorker, ESPMode::ThreadSafe> CreateWorker(
 		const FName& InOperationName) const;
 
-	// Run a command synchronously.
-	ECommandResult::Type ExecuteSynchronousCommand(class FUeLfsCommand& InCommand,
+	// Run commands synchronously, in parallel; succeeds if all of them do.
+	ECommandResult::Type ExecuteSynchronousCommands(const TArray<class FUeLfsCommand*>& InCommands,
 		const FText& Task,
 		bool bSuppressResponseMsg);
 
@@ -97,6 +155,24 @@ private:
 	ECommandResult::Type IssueCommand(class FUeLfsCommand& InCommand,
 		const bool bSynchronous);
 
+	// Replace directories and wildcard paths with the files they cover.
+	void ExpandPaths(const TArray<FString>& InPaths, TArray<FString>& OutFiles);
+
+	// Swap in the rebuilt path trie if it is ready. Waits for it if it adds repositories and bWaitForNewRepos.
+	void FinishPathTrie(bool bWaitForNewRepos);
+
+	// Create a command for each repository owning some of the files.
+	// Files of no repository go with the configured one, as does an operation without files.
+	void CreateRepoCommands(const TSharedRef<ISourceControlOperation, ESPMode::ThreadSafe>& InOperation,
+		const TArray<FString>& InFiles,
+		TArray<class FUeLfsCommand*>& OutCommands);
+
+	// Find in-flight commands that already cover some of the files of an operation.
+	// Covered files are removed from InOutFiles.
+	void FindCoveringCommands(const ISourceControlOperation& InOperation,
+		TArray<FString>& InOutFiles,
+		TArray<class FUeLfsCommand*>& OutCommands);
+
 	// Output any messages this command holds
 	void OutputCommandMessages(const class FUeLfsCommand& InCommand) const;
 
@@ -106,9 +182,39 @@ private:
 
 private:
 
+	/** Settings being discovered in the background, applied by FinishDiscovery() */
+	TFuture<FString> GitBinaryPathFuture;
+	TFuture<FString> RepoRootPathFuture;
+	TFuture<FString> UserNameFuture;
+	bool bDiscoveryPending;
+
 	/** State cache */
 	TMap<FString, TSharedRef<class FUeLfsState, ESPMode::ThreadSafe>> StateCache;
 
+	/** File histories, shared by all commands */
+	FUeLfsHistoryCache HistoryCache;
+
+	/** File contents exported for diffs, shared by all revisions */
+	FUeLfsBlobCache BlobCache;
+
+	/** Files changed upstream, and the version of them last applied to StateCache */
+	FUeLfsOutdatedFiles OutdatedFiles;
+	uint32 AppliedOutdatedVersion;
+
+	/** Lockable file patterns from .gitattributes */
+	FUeLfsLockableMatcher LockableMatcher;
+
+	/** Repositories owning the files, by directory */
+	FUeLfsRepoResolver RepoResolver;
+
+	/** Tracked and cached files by path, and the index time stamps of the repositories it was built from */
+	FUeLfsPathTrie PathTrie;
+	TMap<FString, FDateTime> PathTrieIndexTimeStamps;
+
+	/** Path trie being rebuilt in the background, and the index time stamps it is built from */
+	TFuture<TSharedPtr<FUeLfsPathTrie, ESPMode::ThreadSafe>> PathTrieFuture;
+	TMap<FString, FDateTime> PendingPathTrieIndexTimeStamps;
+
 	/** The currently registered source control operations */
 	TMap<FName, FGetUeLfsWorker> WorkersMap;
 
@@ -0,0 +1,177 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#include "UeLfsRepoResolver.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "ISourceControlModule.h"
+#include "UeLfsUtils.h"
+#include "UeLfsTrace.h"
+
+FUeLfsRepoInfoRef FUeLfsRepoResolver::Resolve(const FString& Path, const FString& DefaultRootPath)
+{
+	FString NormalizedPath = Path;
+	FPaths::NormalizeFilename(NormalizedPath);
+
+	FScopeLock ScopeLock(&CriticalSection);
+
+	TSharedPtr<const FUeLfsRepoInfo, ESPMode::ThreadSafe> Repo = ResolveDirectory(FPaths::GetPath(NormalizedPath));
+	if (!Repo.IsValid())
+	{
+		FString NormalizedRootPath = DefaultRootPath;
+		FPaths::NormalizeDirectoryName(NormalizedRootPath);
+		Repo = ResolveDirectory(NormalizedRootPath);
+	}
+
+	if (!Repo.IsValid())
+	{
+		// Not even the default root is a repository; commands will fail there as they always did.
+		TSharedRef<FUeLfsRepoInfo, ESPMode::ThreadSafe> DefaultRepo = MakeShared<FUeLfsRepoInfo, ESPMode::ThreadSafe>();
+		DefaultRepo->RootPath = DefaultRootPath;
+		DefaultRepo->GitDirPath = DefaultRootPath / TEXT(".git");
+		return DefaultRepo;
+	}
+
+	return Repo.ToSharedRef();
+}
+
+void FUeLfsRepoResolver::GetRepos(TArray<FUeLfsRepoInfoRef>& OutRepos) const
+{
+	FScopeLock ScopeLock(&CriticalSection);
+
+	OutRepos.Append(Repos);
+}
+
+void FUeLfsRepoResolver::Reset()
+{
+	FScopeLock ScopeLock(&CriticalSection);
+
+	Root.Children.Reset();
+	Repos.Reset();
+}
+
+TSharedPtr<const FUeLfsRepoInfo, ESPMode::ThreadSafe> FUeLfsRepoResolver::ResolveDirectory(const FString& DirPath)
+{
+	TArray<FString> Components;
+	DirPath.ParseIntoArray(Components, TEXT("/"), true);
+
+	// The deepest root above the directory owns it; nested repositories win over their parents.
+	TSharedPtr<const FUeLfsRepoInfo, ESPMode::ThreadSafe> Owner;
+	FString CurrentPath = DirPath.StartsWith(TEXT("/")) ? TEXT("/") : TEXT("");
+	FNode* Node = &Root;
+	for (const FString& Component : Components)
+	{
+		CurrentPath += Component;
+		CurrentPath += TEXT('/');
+
+		TUniquePtr<FNode>& Child = Node->Children.FindOrAdd(Component);
+		if (!Child.IsValid())
+		{
+			Child = MakeUnique<FNode>();
+		}
+		Node = Child.Get();
+
+		if (!Node->bProbed)
+		{
+			Node->bProbed = true;
+			Node->Repo = Probe(CurrentPath);
+
+			if (Node->Repo.IsValid())
+			{
+				UE_LOG(LogSourceControl, Log, TEXT("[UeLfs] Found repository %s (git dir %s)"),
+					*Node->Repo->RootPath, *Node->Repo->GitDirPath);
+
+				Repos.Add(Node->Repo.ToSharedRef());
+				AddSubmodules(*Node->Repo);
+			}
+		}
+
+		if (Node->Repo.IsValid())
+		{
+			Owner = Node->Repo;
+		}
+	}
+
+	return Owner;
+}
+
+TSharedPtr<const FUeLfsRepoInfo, ESPMode::ThreadSafe> FUeLfsRepoResolver::Probe(const FString& DirPath)
+{
+	const FString GitDirPath = UeLfsUtils::GetGitDirPath(DirPath);
+	if (GitDirPath.IsEmpty())
+	{
+		return nullptr;
+	}
+
+	UELFS_TRACE_SCOPE(UeLfs_ProbeRepo);
+
+	TSharedRef<FUeLfsRepoInfo, ESPMode::ThreadSafe> Repo = MakeShared<FUeLfsRepoInfo, ESPMode::ThreadSafe>();
+	Repo->RootPath = DirPath;
+	Repo->GitDirPath = GitDirPath;
+	Repo->ServerUrl = ReadServerUrl(GitDirPath / TEXT("config"));
+	return Repo;
+}
+
+void FUeLfsRepoResolver::AddSubmodules(const FUeLfsRepoInfo& Repo)
+{
+	FString ModulesText;
+	if (!FFileHelper::LoadFileToString(ModulesText, *(Repo.RootPath / TEXT(".gitmodules"))))
+	{
+		return;
+	}
+
+	// Only the 'path = <dir>' lines matter here.
+	TArray<FString> Lines;
+	ModulesText.ParseIntoArrayLines(Lines);
+	for (const FString& Line : Lines)
+	{
+		FString Key;
+		FString Value;
+		if (Line.Split(TEXT("="), &Key, &Value) && Key.TrimStartAndEnd() == TEXT("path"))
+		{
+			// Uninitialized submodules have no '.git' and stay part of the parent.
+			FString SubmodulePath = Repo.RootPath / Value.TrimStartAndEnd();
+			FPaths::NormalizeDirectoryName(SubmodulePath);
+			ResolveDirectory(SubmodulePath);
+		}
+	}
+}
+
+FString FUeLfsRepoResolver::ReadServerUrl(const FString& ConfigFilePath)
+{
+	FString ConfigText;
+	if (!FFileHelper::LoadFileToString(ConfigText, *ConfigFilePath))
+	{
+		return FString();
+	}
+
+	// [uelfs]
+	//     serverUrl = http://host:port
+	// Section and key names are case-insensitive in git config.
+	bool bInSection = false;
+	TArray<FString> Lines;
+	ConfigText.ParseIntoArrayLines(Lines);
+	for (const FString& RawLine : Lines)
+	{
+		const FString Line = RawLine.TrimStartAndEnd();
+		if (Line.StartsWith(TEXT("[")))
+		{
+			bInSection = Line.Equals(TEXT("[uelfs]"), ESearchCase::IgnoreCase);
+			continue;
+		}
+
+		FString Key;
+		FString Value;
+		if (bInSection && Line.Split(TEXT("="), &Key, &Value) &&
+			Key.TrimStartAndEnd().Equals(TEXT("serverUrl"), ESearchCase::IgnoreCase))
+		{
+			Value.TrimStartAndEndInline();
+			Value.TrimQuotesInline();
+			return Value;
+		}
+	}
+
+	return FString();
+}
@@ -0,0 +1,80 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+
+/** A git repository that files of the project live in */
+struct FUeLfsRepoInfo
+{
+	/** Root of the working tree, with a trailing slash */
+	FString RootPath;
+
+	/** Where git keeps the repository; elsewhere than '<root>/.git' for submodules and worktrees */
+	FString GitDirPath;
+
+	/** Lock server from 'uelfs.serverUrl' in the repository's git config; empty to use the configured server */
+	FString ServerUrl;
+};
+
+typedef TSharedRef<const FUeLfsRepoInfo, ESPMode::ThreadSafe> FUeLfsRepoInfoRef;
+
+/**
+ * Finds the repository owning a path: the nearest directory above it with a '.git'.
+ * Which directories are repository roots is cached by path component, so each directory is
+ * looked at once and later paths are resolved without touching the disk. Submodules listed
+ * in a repository's .gitmodules are found along with it.
+ * Used from any thread, so all access is guarded.
+ */
+class FUeLfsRepoResolver
+{
+public:
+	/**
+	 * Get the repository owning a path (a file, or a directory with a trailing slash).
+	 * Paths outside of any repository belong to the repository at DefaultRootPath.
+	 */
+	FUeLfsRepoInfoRef Resolve(const FString& Path, const FString& DefaultRootPath);
+
+	/** Get the repositories found so far. */
+	void GetRepos(TArray<FUeLfsRepoInfoRef>& OutRepos) const;
+
+	/** Forget everything found, e.g. after repositories were added or removed. */
+	void Reset();
+
+private:
+	struct FNode
+	{
+		TMap<FString, TUniquePtr<FNode>> Children;
+
+		/** If true, the directory has been looked at */
+		bool bProbed = false;
+
+		/** Set if the directory is a repository root */
+		TSharedPtr<const FUeLfsRepoInfo, ESPMode::ThreadSafe> Repo;
+	};
+
+	// Find the repository owning a directory, looking at directories not seen before.
+	TSharedPtr<const FUeLfsRepoInfo, ESPMode::ThreadSafe> ResolveDirectory(const FString& DirPath);
+
+	// Look for a repository rooted at the directory (with a trailing slash).
+	static TSharedPtr<const FUeLfsRepoInfo, ESPMode::ThreadSafe> Probe(const FString& DirPath);
+
+	// Find the submodules of a repository.
+	void AddSubmodules(const FUeLfsRepoInfo& Repo);
+
+	// Read 'uelfs.serverUrl' from a git config file.
+	static FString ReadServerUrl(const FString& ConfigFilePath);
+
+private:
+	/** A critical section for cache access */
+	mutable FCriticalSection CriticalSection;
+
+	/** Directories looked at so far, by path component */
+	FNode Root;
+
+	/** Repositories found so far */
+	TArray<FUeLfsRepoInfoRef> Repos;
+};
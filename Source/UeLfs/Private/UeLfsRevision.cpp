@@ -15,17 +15,19 @@
 
 bool FUeLfsRevision::Get( FString& InOutFilename ) const
 {
-	//SubversionSourceControlUtils::CheckFilename(Filename);
-
 	FUeLfsModule& UeLfs = FModuleManager::LoadModuleChecked<FUeLfsModule>( "UeLfs" );
 	FUeLfsProvider& Provider = UeLfs.GetProvider();
+	const FString RepoRootPath = Provider.ResolveRepo(Filename)->RootPath;
 
-	TArray<FString> Results;
-	TArray<FString> Parameters;
-	TArray<FString> ErrorMessages;
+	FString GitFilePath = RepoFilename;
+	if (GitFilePath.IsEmpty())
+	{
+		GitFilePath = Filename;
+		FPaths::MakePathRelativeTo(GitFilePath, *RepoRootPath);
+	}
 
 	// Make temp filename to export to
-	FString RevString = (RevisionNumber < 0) ? TEXT("HEAD") : FString::Printf(TEXT("%d"), RevisionNumber);
+	FString RevString = CommitId.IsEmpty() ? TEXT("HEAD") : Revision;
 	FString AbsoluteFileName;
 	if(InOutFilename.Len() > 0)
 	{
@@ -33,7 +35,7 @@ bool FUeLfsRevision::Get( FString& InOutFilename ) const
 	}
 	else
 	{
-		// create the diff dir if we don't already have it (SVN wont)
+		// create the diff dir if we don't already have it
 		IFileManager::Get().MakeDirectory(*FPaths::DiffDir(), true);
 
 		static int32 TempFileCount = 0;
@@ -41,30 +43,17 @@ bool FUeLfsRevision::Get( FString& InOutFilename ) const
 		AbsoluteFileName = FPaths::ConvertRelativePathToFull(TempFileName);
 	}
 
-	Parameters.Add(FString(TEXT("--revision ")) + RevString);
-	Parameters.Add(TEXT("--force"));
-
-	TArray<FString> Files;
-	Files.Add(Filename);
-	Files.Add(AbsoluteFileName);
-
-	//if(UeLfsUtils::RunCommand(TEXT("export"), Files, Parameters, Results, ErrorMessages, Provider.GetUserName()))
-	//{
-	//	InOutFilename = AbsoluteFileName;
-	//	return true;
-	//}
-	//else
-	//{
-	//	for(auto Iter(ErrorMessages.CreateConstIterator()); Iter; Iter++)
-	//	{
-	//		FMessageLog("SourceControl").Error(FText::FromString(*Iter));
-	//	}
-	//}
-
-	//return false;
-
-	InOutFilename = AbsoluteFileName;
-	return true;
+	const FString& ExportRevision = CommitId.IsEmpty() ? RevString : CommitId;
+	if (Provider.GetBlobCache().Export(RepoRootPath, ExportRevision, GitFilePath, AbsoluteFileName))
+	{
+		InOutFilename = AbsoluteFileName;
+		return true;
+	}
+
+	FMessageLog("SourceControl").Error(FText::Format(LOCTEXT("ExportFailed", "Failed to export {0} at revision {1}."),
+		FText::FromString(GitFilePath),
+		FText::FromString(RevString)));
+	return false;
 }
 
 static bool IsWhiteSpace(TCHAR InChar)
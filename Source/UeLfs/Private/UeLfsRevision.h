@@ -43,6 +43,9 @@ public:
 	/** The revision to display to users */
 	FString Revision;
 
+	/** The full git commit hash of this revision */
+	FString CommitId;
+
 	/** The description of this revision */
 	FString Description;
 
@@ -58,6 +61,6 @@ public:
 	/** The date this revision was made */
 	FDateTime Date;
 
-	/** The repo URL */
+	/** The path of the file relative to the repository root */
 	FString RepoFilename;
 };
@@ -14,70 +14,205 @@ namespace UeLfsSettingsConstants
 	static const FString SettingsSection = TEXT("UeLfs.UeLfsSettings");
 }
 
-const FString& FUeLfsSettings::GetServerUrl() const
+FUeLfsSettings::FUeLfsSettings()
+	: Current(MakeShared<FUeLfsSettingsSnapshot, ESPMode::ThreadSafe>())
+	, Saved(Current)
 {
+}
+
+FUeLfsSettingsSnapshotRef FUeLfsSettings::GetSnapshot() const
+{
+	// Only long enough to take a reference; the snapshot itself is never modified.
 	FScopeLock ScopeLock(&CriticalSection);
-	return ServerUrl;
+	return Current;
 }
 
-void FUeLfsSettings::SetServerUrl(const FString& InString)
+template<typename MemberType>
+void FUeLfsSettings::SetMember(MemberType FUeLfsSettingsSnapshot::*Member, const MemberType& InValue)
 {
 	FScopeLock ScopeLock(&CriticalSection);
-	ServerUrl = InString;
+
+	// Don't publish (and mark dirty) a value that did not change.
+	if (Current.Get().*Member == InValue)
+	{
+		return;
+	}
+
+	FUeLfsSettingsSnapshot Snapshot = Current.Get();
+	Snapshot.*Member = InValue;
+	Publish(Snapshot);
 }
 
-const FString& FUeLfsSettings::GetUserName() const
+void FUeLfsSettings::Publish(const FUeLfsSettingsSnapshot& InSnapshot)
 {
 	FScopeLock ScopeLock(&CriticalSection);
-	return UserName;
+
+	TSharedRef<FUeLfsSettingsSnapshot, ESPMode::ThreadSafe> Snapshot = MakeShared<FUeLfsSettingsSnapshot, ESPMode::ThreadSafe>(InSnapshot);
+	Snapshot->Version = Current->Version + 1;
+
+	// Readers still holding the previous snapshot keep it alive until they are done.
+	Current = Snapshot;
+}
+
+FString FUeLfsSettings::GetServerUrl() const
+{
+	return GetSnapshot()->ServerUrl;
+}
+
+void FUeLfsSettings::SetServerUrl(const FString& InString)
+{
+	SetMember(&FUeLfsSettingsSnapshot::ServerUrl, InString);
+}
+
+FString FUeLfsSettings::GetUserName() const
+{
+	return GetSnapshot()->UserName;
 }
 
 void FUeLfsSettings::SetUserName(const FString& InString)
 {
-	FScopeLock ScopeLock(&CriticalSection);
-	UserName = InString;
+	SetMember(&FUeLfsSettingsSnapshot::UserName, InString);
 }
 
-const FString& FUeLfsSettings::GetGitBinaryPath() const
+FString FUeLfsSettings::GetGitBinaryPath() const
 {
-	FScopeLock ScopeLock(&CriticalSection);
-	return GitBinaryPath;
+	return GetSnapshot()->GitBinaryPath;
 }
 
 void FUeLfsSettings::SetGitBinaryPath(const FString& InString)
 {
-	FScopeLock ScopeLock(&CriticalSection);
-	GitBinaryPath = InString;
+	SetMember(&FUeLfsSettingsSnapshot::GitBinaryPath, InString);
 }
 
-const FString& FUeLfsSettings::GetRepoRootPath() const
+FString FUeLfsSettings::GetRepoRootPath() const
 {
-	FScopeLock ScopeLock(&CriticalSection);
-	return RepoRootPath;
+	return GetSnapshot()->RepoRootPath;
 }
 
 void FUeLfsSettings::SetRepoRootPath(const FString& InString)
 {
-	FScopeLock ScopeLock(&CriticalSection);
-	RepoRootPath = InString;
+	SetMember(&FUeLfsSettingsSnapshot::RepoRootPath, InString);
+}
+
+FString FUeLfsSettings::GetPushRemote() const
+{
+	return GetSnapshot()->PushRemote;
+}
+
+void FUeLfsSettings::SetPushRemote(const FString& InString)
+{
+	SetMember(&FUeLfsSettingsSnapshot::PushRemote, InString);
+}
+
+FString FUeLfsSettings::GetPullRemote() const
+{
+	return GetSnapshot()->PullRemote;
+}
+
+void FUeLfsSettings::SetPullRemote(const FString& InString)
+{
+	SetMember(&FUeLfsSettingsSnapshot::PullRemote, InString);
+}
+
+bool FUeLfsSettings::GetPrimeLockTable() const
+{
+	return GetSnapshot()->bPrimeLockTable;
+}
+
+void FUeLfsSettings::SetPrimeLockTable(bool bInValue)
+{
+	SetMember(&FUeLfsSettingsSnapshot::bPrimeLockTable, bInValue);
+}
+
+bool FUeLfsSettings::GetPrefetchDependencies() const
+{
+	return GetSnapshot()->bPrefetchDependencies;
+}
+
+void FUeLfsSettings::SetPrefetchDependencies(bool bInValue)
+{
+	SetMember(&FUeLfsSettingsSnapshot::bPrefetchDependencies, bInValue);
+}
+
+FString FUeLfsSettings::GetDiscoveryFingerprint() const
+{
+	return GetSnapshot()->DiscoveryFingerprint;
+}
+
+void FUeLfsSettings::SetDiscoveryFingerprint(const FString& InString)
+{
+	SetMember(&FUeLfsSettingsSnapshot::DiscoveryFingerprint, InString);
 }
 
 void FUeLfsSettings::LoadSettings()
 {
 	FScopeLock ScopeLock(&CriticalSection);
 	const FString& IniFile = SourceControlHelpers::GetSettingsIni();
-	GConfig->GetString(*UeLfsSettingsConstants::SettingsSection, TEXT("ServerUrl"), ServerUrl, IniFile);
-	GConfig->GetString(*UeLfsSettingsConstants::SettingsSection, TEXT("UserName"), UserName, IniFile);
-	GConfig->GetString(*UeLfsSettingsConstants::SettingsSection, TEXT("GitBinaryPath"), GitBinaryPath, IniFile);
-	GConfig->GetString(*UeLfsSettingsConstants::SettingsSection, TEXT("RepoRootPath"), RepoRootPath, IniFile);
+
+	FUeLfsSettingsSnapshot Snapshot = Current.Get();
+	GConfig->GetString(*UeLfsSettingsConstants::SettingsSection, TEXT("ServerUrl"), Snapshot.ServerUrl, IniFile);
+	GConfig->GetString(*UeLfsSettingsConstants::SettingsSection, TEXT("UserName"), Snapshot.UserName, IniFile);
+	GConfig->GetString(*UeLfsSettingsConstants::SettingsSection, TEXT("GitBinaryPath"), Snapshot.GitBinaryPath, IniFile);
+	GConfig->GetString(*UeLfsSettingsConstants::SettingsSection, TEXT("RepoRootPath"), Snapshot.RepoRootPath, IniFile);
+	GConfig->GetString(*UeLfsSettingsConstants::SettingsSection, TEXT("PushRemote"), Snapshot.PushRemote, IniFile);
+	GConfig->GetString(*UeLfsSettingsConstants::SettingsSection, TEXT("PullRemote"), Snapshot.PullRemote, IniFile);
+	GConfig->GetString(*UeLfsSettingsConstants::SettingsSection, TEXT("DiscoveryFingerprint"), Snapshot.DiscoveryFingerprint, IniFile);
+	GConfig->GetBool(*UeLfsSettingsConstants::SettingsSection, TEXT("PrimeLockTable"), Snapshot.bPrimeLockTable, IniFile);
+	GConfig->GetBool(*UeLfsSettingsConstants::SettingsSection, TEXT("PrefetchDependencies"), Snapshot.bPrefetchDependencies, IniFile);
+	Publish(Snapshot);
+
+	Saved = Current;
 }
 
-void FUeLfsSettings::SaveSettings() const
+void FUeLfsSettings::SaveSettings()
 {
 	FScopeLock ScopeLock(&CriticalSection);
+
+	const FUeLfsSettingsSnapshot& Snapshot = Current.Get();
+	const FUeLfsSettingsSnapshot& SavedSnapshot = Saved.Get();
+	if (&Snapshot == &SavedSnapshot)
+	{
+		return;
+	}
+
+	// Only touch the keys that changed, so an unchanged ini is not marked dirty.
 	const FString& IniFile = SourceControlHelpers::GetSettingsIni();
-	GConfig->SetString(*UeLfsSettingsConstants::SettingsSection, TEXT("ServerUrl"), *ServerUrl, IniFile);
-	GConfig->SetString(*UeLfsSettingsConstants::SettingsSection, TEXT("UserName"), *UserName, IniFile);
-	GConfig->SetString(*UeLfsSettingsConstants::SettingsSection, TEXT("GitBinaryPath"), *GitBinaryPath, IniFile);
-	GConfig->SetString(*UeLfsSettingsConstants::SettingsSection, TEXT("RepoRootPath"), *RepoRootPath, IniFile);
+	auto SaveString = [&](const TCHAR* Key, FString FUeLfsSettingsSnapshot::*Member)
+	{
+		if (Snapshot.*Member != SavedSnapshot.*Member)
+		{
+			GConfig->SetString(*UeLfsSettingsConstants::SettingsSection, Key, *(Snapshot.*Member), IniFile);
+		}
+	};
+	auto SaveBool = [&](const TCHAR* Key, bool FUeLfsSettingsSnapshot::*Member)
+	{
+		if (Snapshot.*Member != SavedSnapshot.*Member)
+		{
+			GConfig->SetBool(*UeLfsSettingsConstants::SettingsSection, Key, Snapshot.*Member, IniFile);
+		}
+	};
+
+	SaveString(TEXT("ServerUrl"), &FUeLfsSettingsSnapshot::ServerUrl);
+	SaveString(TEXT("UserName"), &FUeLfsSettingsSnapshot::UserName);
+	SaveString(TEXT("GitBinaryPath"), &FUeLfsSettingsSnapshot::GitBinaryPath);
+	SaveString(TEXT("RepoRootPath"), &FUeLfsSettingsSnapshot::RepoRootPath);
+	SaveString(TEXT("PushRemote"), &FUeLfsSettingsSnapshot::PushRemote);
+	SaveString(TEXT("PullRemote"), &FUeLfsSettingsSnapshot::PullRemote);
+	SaveString(TEXT("DiscoveryFingerprint"), &FUeLfsSettingsSnapshot::DiscoveryFingerprint);
+	SaveBool(TEXT("PrimeLockTable"), &FUeLfsSettingsSnapshot::bPrimeLockTable);
+	SaveBool(TEXT("PrefetchDependencies"), &FUeLfsSettingsSnapshot::bPrefetchDependencies);
+
+	Saved = Current;
+}
+
+bool FUeLfsSettings::IsDirty() const
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	return Current != Saved;
+}
+
+FUeLfsSettingsSnapshotRef FUeLfsSettings::GetSavedSnapshot() const
+{
+	FScopeLock ScopeLock(&CriticalSection);
+	return Saved;
 }
@@ -6,33 +6,103 @@
 
 #include "CoreMinimal.h"
 
+/**
+ * One published version of the settings. Never modified once published,
+ * so any thread can read it without locking.
+ */
+struct FUeLfsSettingsSnapshot
+{
+	FUeLfsSettingsSnapshot()
+		: Version(0)
+		, bPrimeLockTable(false)
+		, bPrefetchDependencies(true)
+	{
+	}
+
+	/** Bumped on every change */
+	uint32 Version;
+
+	FString ServerUrl;
+	FString UserName;
+	FString GitBinaryPath;
+	FString RepoRootPath;
+	FString PushRemote;
+	FString PullRemote;
+	FString DiscoveryFingerprint;
+	bool bPrimeLockTable;
+	bool bPrefetchDependencies;
+};
+
+typedef TSharedRef<const FUeLfsSettingsSnapshot, ESPMode::ThreadSafe> FUeLfsSettingsSnapshotRef;
+
 class FUeLfsSettings
 {
 public:
-	const FString& GetServerUrl() const;
+	FUeLfsSettings();
+
+	/**
+	 * Get the current settings. The snapshot stays valid (and unchanged) for as long as
+	 * it is held, however often the settings change.
+	 */
+	FUeLfsSettingsSnapshotRef GetSnapshot() const;
+
+	FString GetServerUrl() const;
 	void SetServerUrl(const FString& InString);
 
-	const FString& GetUserName() const;
+	FString GetUserName() const;
 	void SetUserName(const FString& InString);
 
-	const FString& GetGitBinaryPath() const;
+	FString GetGitBinaryPath() const;
 	void SetGitBinaryPath(const FString& InString);
 
-	const FString& GetRepoRootPath() const;
+	FString GetRepoRootPath() const;
 	void SetRepoRootPath(const FString& InString);
 
+	/** Remote (name or URL) to push to after check-in. Empty to only commit locally. */
+	FString GetPushRemote() const;
+	void SetPushRemote(const FString& InString);
+
+	/** Remote (name or URL) to pull from on sync when the branch has no upstream. Empty to need an upstream. */
+	FString GetPullRemote() const;
+	void SetPullRemote(const FString& InString);
+
+	/** Load the whole lock table at Connect, instead of querying locks file by file later */
+	bool GetPrimeLockTable() const;
+	void SetPrimeLockTable(bool bInValue);
+
+	bool GetPrefetchDependencies() const;
+	void SetPrefetchDependencies(bool bInValue);
+
+	/** Fingerprint of the environment the discovered settings were valid for */
+	FString GetDiscoveryFingerprint() const;
+	void SetDiscoveryFingerprint(const FString& InString);
+
 	/** Load settings from ini file */
 	void LoadSettings();
 
-	/** Save settings to ini file */
-	void SaveSettings() const;
+	/** Write the keys changed since the last save (or load) to the ini */
+	void SaveSettings();
+
+	/** Whether there are changes not yet written to the ini */
+	bool IsDirty() const;
+
+	/** The settings as they were last saved (or loaded) */
+	FUeLfsSettingsSnapshotRef GetSavedSnapshot() const;
 
 private:
-	/** A critical section for settings access */
+	// Publish a modified copy of the current snapshot, unless nothing changed.
+	template<typename MemberType>
+	void SetMember(MemberType FUeLfsSettingsSnapshot::*Member, const MemberType& InValue);
+
+	void Publish(const FUeLfsSettingsSnapshot& InSnapshot);
+
+private:
+	/** A critical section for writers, and for readers taking a reference to the current snapshot */
 	mutable FCriticalSection CriticalSection;
 
-	FString ServerUrl;
-	FString UserName;
-	FString GitBinaryPath;
-	FString RepoRootPath;
+	/** The current snapshot */
+	FUeLfsSettingsSnapshotRef Current;
+
+	/** The snapshot last written to (or read from) the ini; diffed against the current one to find dirty keys */
+	FUeLfsSettingsSnapshotRef Saved;
 };
@@ -19,11 +19,28 @@ TSharedPtr<class ISourceControlRevision, ESPMode::ThreadSafe> FUeLfsState::GetHi
 
 TSharedPtr<class ISourceControlRevision, ESPMode::ThreadSafe> FUeLfsState::FindHistoryRevision( int32 RevisionNumber ) const
 {
+	for (const TSharedRef<FUeLfsRevision, ESPMode::ThreadSafe>& Revision : History)
+	{
+		if (Revision->RevisionNumber == RevisionNumber)
+		{
+			return Revision;
+		}
+	}
+
 	return nullptr;
 }
 
 TSharedPtr<class ISourceControlRevision, ESPMode::ThreadSafe> FUeLfsState::FindHistoryRevision(const FString& InRevision) const
 {
+	// Accept both the displayed (short) and the full commit hash.
+	for (const TSharedRef<FUeLfsRevision, ESPMode::ThreadSafe>& Revision : History)
+	{
+		if (!InRevision.IsEmpty() && Revision->CommitId.StartsWith(InRevision))
+		{
+			return Revision;
+		}
+	}
+
 	return nullptr;
 }
 
@@ -147,7 +164,7 @@ bool FUeLfsState::IsCheckedOutOther(FString* Who) const
 
 bool FUeLfsState::IsCurrent() const
 {
-	return true;
+	return bIsCurrent;
 }
 
 bool FUeLfsState::IsSourceControlled() const
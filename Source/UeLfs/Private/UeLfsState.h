@@ -7,6 +7,7 @@
 #include "CoreMinimal.h"
 #include "ISourceControlRevision.h"
 #include "UeLfsRevision.h"
+#include "UeLfsHistory.h"
 #include "ISourceControlState.h"
 
 namespace EWorkingCopyState
@@ -43,6 +44,7 @@ public:
 		: LocalFileName(InLocalFilename)
 		, WorkingCopyState(EWorkingCopyState::Unknown)
 		, LockState(ELockState::Unknown)
+		, bIsCurrent(true)
 		, TimeStamp(0)
 	{
 	}
@@ -83,8 +85,8 @@ public:
 	virtual bool CanRevert() const override;
 
 public:
-	// History of the item, if any.  (dummy)
-	TArray< TSharedRef<FUeLfsRevision, ESPMode::ThreadSafe> > History;
+	// History of the item, if any.  (filled by UpdateStatus with history requested)
+	FUeLfsHistory History;
 
 	// Local file name.  (absolute path)
 	FString LocalFileName;
@@ -104,6 +106,9 @@ public:
 	// Last commit hash.
 	FString LastCommitHash;
 
+	// Whether the file is unchanged upstream since HEAD.
+	bool bIsCurrent;
+
 	// The timestamp of the last update. (not used)
 	FDateTime TimeStamp;
 };
@@ -0,0 +1,7 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#include "UeLfsTrace.h"
+
+UE_TRACE_CHANNEL_DEFINE(UeLfsChannel);
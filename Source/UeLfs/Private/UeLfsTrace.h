@@ -0,0 +1,16 @@
+// ----------------------------------------------------------------------------
+// © 2022 Eungsik Yoon <yoon.eungsik@gmail.com>
+// ----------------------------------------------------------------------------
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Trace/Trace.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CountersTrace.h"
+
+// Trace channel for everything UeLfs does. Enable with "-trace=cpu,counters,UeLfs".
+UE_TRACE_CHANNEL_EXTERN(UeLfsChannel);
+
+// CPU scope on the UeLfs channel.
+#define UELFS_TRACE_SCOPE(Name) TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Name, UeLfsChannel)
@@ -4,6 +4,7 @@
 
 #include "UeLfsUtils.h"
 #include "UeLfsSettings.h"
+#include "UeLfsRepoResolver.h"
 #include "ISourceControlModule.h"
 #include "Interfaces/IHttpRequest.h"
 #include "Interfaces/IHttpResponse.h"
@@ -11,6 +12,7 @@
 #include "HttpManager.h"
 #include "HAL/PlatformTime.h"
 #include "HAL/PlatformProcess.h"
+#include "HAL/Event.h"
 #include "HAL/FileManager.h"
 #include "Dom/JsonValue.h"
 #include "Dom/JsonObject.h"
@@ -18,39 +20,182 @@
 #include "Serialization/JsonWriter.h"
 #include "Serialization/JsonSerializer.h"
 #include "Misc/Paths.h"
+#include "Misc/FileHelper.h"
+#include "Misc/SecureHash.h"
+#include "Misc/Guid.h"
 #include "Misc/MessageDialog.h"
+#include "UeLfsTrace.h"
+
+TRACE_DECLARE_INT_COUNTER(UeLfs_GitInvocations, TEXT("UeLfs/Git/Invocations"));
+TRACE_DECLARE_FLOAT_COUNTER(UeLfs_GitDurationMs, TEXT("UeLfs/Git/DurationMs"));
+TRACE_DECLARE_INT_COUNTER(UeLfs_HttpRequests, TEXT("UeLfs/Http/Requests"));
+TRACE_DECLARE_INT_COUNTER(UeLfs_HttpBytesSent, TEXT("UeLfs/Http/BytesSent"));
+TRACE_DECLARE_INT_COUNTER(UeLfs_HttpBytesReceived, TEXT("UeLfs/Http/BytesReceived"));
+TRACE_DECLARE_INT_COUNTER(UeLfs_HttpStatus, TEXT("UeLfs/Http/Status"));
+TRACE_DECLARE_FLOAT_COUNTER(UeLfs_HttpLatencyMs, TEXT("UeLfs/Http/LatencyMs"));
+TRACE_DECLARE_INT_COUNTER(UeLfs_HttpInFlight, TEXT("UeLfs/Http/InFlight"));
+
+namespace UeLfsUtilsConstants
+{
+	/** How often the game thread ticks the http manager while it waits for a response */
+	static const uint32 HttpTickIntervalMs = 10;
+
+	/** Tries per request, including the first one */
+	static const int32 HttpMaxAttempts = 3;
+
+	/** Backoff before the first retry; doubled for every further retry */
+	static const float HttpRetryBaseDelay = 0.25f;
+
+	/** Upper bound of the backoff */
+	static const float HttpRetryMaxDelay = 2.0f;
+
+	/** Timeout of endpoints not listed in HttpEndpointPolicies */
+	static const float HttpDefaultTimeout = 15.0f;
+
+	/** Most stderr bytes of a streamed git command kept for the log */
+	static const int32 MaxStdErrBytes = 16 * 1024;
 
-bool UeLfsUtils::CheckFilename(const FString& FileName)
+	/** Length of the path arguments of one git command line, well below the Windows limit of 32767 characters */
+	static const int32 MaxPathArgsLen = 16 * 1024;
+
+	/** Seconds a streamed git command waits for more output when its pipes were empty */
+	static const float PipePollInterval = 0.001f;
+}
+
+/** How requests to one server endpoint are sent */
+struct FUeLfsEndpointPolicy
 {
-	if (FileName.Contains(TEXT("...")) ||
-		FileName.Contains(TEXT("*")) ||
-		FileName.Contains(TEXT("?")))
+	const TCHAR* Endpoint;
+
+	/** Seconds before an unanswered request is cancelled (and maybe retried) */
+	float Timeout;
+
+	/** Whether the request changes locks, and so needs an idempotency key to be retried safely */
+	bool bNeedsIdempotencyKey;
+};
+
+static const FUeLfsEndpointPolicy HttpEndpointPolicies[] =
+{
+	{ TEXT("unsafeLogin"), 10.0f, false },
+	{ TEXT("getAllLocks"), 60.0f, false },
+	{ TEXT("getLockStates"), 30.0f, false },
+	{ TEXT("lockFiles"), 20.0f, true },
+	{ TEXT("unlockFiles"), 20.0f, true },
+	{ TEXT("unlockAll"), 20.0f, true },
+};
+
+static FUeLfsEndpointPolicy GetEndpointPolicy(const TCHAR* Endpoint)
+{
+	for (const FUeLfsEndpointPolicy& Policy : HttpEndpointPolicies)
+	{
+		if (FCString::Strcmp(Policy.Endpoint, Endpoint) == 0)
+		{
+			return Policy;
+		}
+	}
+
+	// Unknown endpoints may change anything; always send a key.
+	return { Endpoint, UeLfsUtilsConstants::HttpDefaultTimeout, true };
+}
+
+// Whether a response says the server may succeed if asked again.
+static bool IsRetryableResponseCode(int32 ResponseCode)
+{
+	return ResponseCode == EHttpResponseCodes::RequestTimeout ||
+		ResponseCode == EHttpResponseCodes::TooManyRequests ||
+		ResponseCode >= EHttpResponseCodes::ServerError;
+}
+
+// Jittered exponential backoff before the given retry (1 for the first retry).
+static float GetRetryDelay(int32 Retry)
+{
+	const float Delay = FMath::Min(UeLfsUtilsConstants::HttpRetryBaseDelay * (float)(1 << (Retry - 1)),
+		UeLfsUtilsConstants::HttpRetryMaxDelay);
+
+	// Keep half of the delay and randomize the rest, so clients that failed together don't retry together.
+	return Delay * 0.5f + FMath::FRand() * Delay * 0.5f;
+}
+
+/**
+ * Completion signal of one http request. Shared with the completion delegate,
+ * which may still fire after a timed out request was given up on.
+ */
+class FUeLfsHttpDoneEvent
+{
+public:
+	FUeLfsHttpDoneEvent()
+		: Event(FPlatformProcess::GetSynchEventFromPool(true))
 	{
-		UE_LOG(LogSourceControl, Warning,
-			TEXT("Filename '%s' with wildcards is not supported by UeLfs"), *FileName);
-		return false;
 	}
 
-	if (!FileName.EndsWith(TEXT(".uasset")) && !FileName.EndsWith(TEXT(".umap")))
+	~FUeLfsHttpDoneEvent()
 	{
-		UE_LOG(LogSourceControl, Warning,
-			TEXT("File '%s' is not supported by UeLfs"), *FileName);
-		return false;
+		FPlatformProcess::ReturnSynchEventToPool(Event);
 	}
 
-	return true;
+	FEvent* const Event;
+};
+
+FUeLfsRecordSplitter::FUeLfsRecordSplitter(ANSICHAR InDelimiter, TFunction<void(const FString&)> InOnRecord)
+	: Delimiter(InDelimiter)
+	, OnRecord(MoveTemp(InOnRecord))
+{
 }
 
-bool UeLfsUtils::CheckFilenames(const TArray<FString>& FileNames)
+void FUeLfsRecordSplitter::Append(const uint8* Data, int32 Num)
 {
-	bool bResult = true;
+	int32 RecordStart = 0;
+	for (int32 Index = 0; Index < Num; ++Index)
+	{
+		if (Data[Index] != (uint8)Delimiter)
+		{
+			continue;
+		}
+
+		if (Pending.Num() > 0)
+		{
+			// Complete the record started in an earlier chunk.
+			Pending.Append(Data + RecordStart, Index - RecordStart);
+			EmitRecord(Pending.GetData(), Pending.Num());
+			Pending.Reset();
+		}
+		else
+		{
+			EmitRecord(Data + RecordStart, Index - RecordStart);
+		}
+
+		RecordStart = Index + 1;
+	}
+
+	Pending.Append(Data + RecordStart, Num - RecordStart);
+}
 
-	for(auto Iter(FileNames.CreateConstIterator()); Iter; Iter++)
+void FUeLfsRecordSplitter::Flush()
+{
+	if (Pending.Num() > 0)
 	{
-		bResult &= CheckFilename(*Iter);
+		EmitRecord(Pending.GetData(), Pending.Num());
+		Pending.Reset();
 	}
+}
 
-	return bResult;
+void FUeLfsRecordSplitter::EmitRecord(const uint8* Data, int32 Num)
+{
+	// Tolerate CRLF line endings.
+	if (Delimiter == '\n' && Num > 0 && Data[Num - 1] == '\r')
+	{
+		--Num;
+	}
+
+	FUTF8ToTCHAR Converted((const ANSICHAR*)Data, Num);
+	OnRecord(FString(Converted.Length(), Converted.Get()));
+}
+
+bool UeLfsUtils::HasWildcards(const FString& FileName)
+{
+	return FileName.Contains(TEXT("...")) ||
+		FileName.Contains(TEXT("*")) ||
+		FileName.Contains(TEXT("?"));
 }
 
 TArray<FString> UeLfsUtils::ToGitFilePaths(const TArray<FString>& AbsFilePaths,
@@ -68,6 +213,272 @@ TArray<FString> UeLfsUtils::ToGitFilePaths(const TArray<FString>& AbsFilePaths,
 	return GitFilePaths;
 }
 
+bool UeLfsUtils::RunGitCommand(const FString& Args, int32& OutReturnCode,
+	FString& OutStdOut, FString& OutStdErr)
+{
+	UELFS_TRACE_SCOPE(UeLfs_Git);
+	TRACE_COUNTER_INCREMENT(UeLfs_GitInvocations);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	OutReturnCode = -1;
+	const bool bLaunched = FPlatformProcess::ExecProcess(TEXT("git"), *Args,
+		&OutReturnCode, &OutStdOut, &OutStdErr);
+
+	const double DurationMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	TRACE_COUNTER_SET(UeLfs_GitDurationMs, DurationMs);
+
+	UE_LOG(LogSourceControl, Verbose, TEXT("[git] %s -> %d (%.1f ms)"),
+		*Args, OutReturnCode, DurationMs);
+
+	return bLaunched && OutReturnCode == 0;
+}
+
+bool UeLfsUtils::RunGitCommandStreamed(const FString& Args, TFunctionRef<void(const uint8*, int32)> OnStdOut,
+	int32& OutReturnCode, const TArray<uint8>* StdIn)
+{
+	UELFS_TRACE_SCOPE(UeLfs_Git);
+	TRACE_COUNTER_INCREMENT(UeLfs_GitInvocations);
+
+	const double StartTime = FPlatformTime::Seconds();
+
+	OutReturnCode = -1;
+
+	void* StdOutRead = nullptr;
+	void* StdOutWrite = nullptr;
+	void* StdErrRead = nullptr;
+	void* StdErrWrite = nullptr;
+	void* StdInRead = nullptr;
+	void* StdInWrite = nullptr;
+	if (!FPlatformProcess::CreatePipe(StdOutRead, StdOutWrite))
+	{
+		return false;
+	}
+	if (!FPlatformProcess::CreatePipe(StdErrRead, StdErrWrite))
+	{
+		FPlatformProcess::ClosePipe(StdOutRead, StdOutWrite);
+		return false;
+	}
+	if (StdIn != nullptr && !FPlatformProcess::CreatePipe(StdInRead, StdInWrite, true))
+	{
+		FPlatformProcess::ClosePipe(StdOutRead, StdOutWrite);
+		FPlatformProcess::ClosePipe(StdErrRead, StdErrWrite);
+		return false;
+	}
+
+	// Stderr gets a pipe of its own; warnings and LFS progress must not end up in the output.
+	FProcHandle ProcHandle = FPlatformProcess::CreateProc(TEXT("git"), *Args,
+		false, true, true, nullptr, 0, nullptr, StdOutWrite, StdInRead, StdErrWrite);
+
+	if (!ProcHandle.IsValid())
+	{
+		FPlatformProcess::ClosePipe(StdOutRead, StdOutWrite);
+		FPlatformProcess::ClosePipe(StdErrRead, StdErrWrite);
+		FPlatformProcess::ClosePipe(StdInRead, StdInWrite);
+		UE_LOG(LogSourceControl, Error, TEXT("[git] Failed to launch: %s"), *Args);
+		return false;
+	}
+
+	// Read as bytes; FPlatformProcess::ReadPipe() converts to text and stops at the first NUL.
+	int64 NumBytes = 0;
+	TArray<uint8> Chunk;
+	TArray<uint8> StdErrBytes;
+	auto DrainStdOut = [&]()
+	{
+		bool bReadAny = false;
+		while (FPlatformProcess::ReadPipeToArray(StdOutRead, Chunk) && Chunk.Num() > 0)
+		{
+			OnStdOut(Chunk.GetData(), Chunk.Num());
+			NumBytes += Chunk.Num();
+			bReadAny = true;
+		}
+
+		// Stderr is only kept for the log, and only its start, to stay in constant memory.
+		while (FPlatformProcess::ReadPipeToArray(StdErrRead, Chunk) && Chunk.Num() > 0)
+		{
+			const int32 NumToKeep = FMath::Min(Chunk.Num(), UeLfsUtilsConstants::MaxStdErrBytes - StdErrBytes.Num());
+			if (NumToKeep > 0)
+			{
+				StdErrBytes.Append(Chunk.GetData(), NumToKeep);
+			}
+			bReadAny = true;
+		}
+		return bReadAny;
+	};
+
+	if (StdIn != nullptr)
+	{
+		// Feed stdin in slices and drain stdout in between, so neither side stalls the other.
+		const int32 SliceSize = 4096;
+		int32 Offset = 0;
+		while (Offset < StdIn->Num() && FPlatformProcess::IsProcRunning(ProcHandle))
+		{
+			int32 NumWritten = 0;
+			const int32 SliceLen = FMath::Min(SliceSize, StdIn->Num() - Offset);
+			if (!FPlatformProcess::WritePipe(StdInWrite, StdIn->GetData() + Offset, SliceLen, &NumWritten))
+			{
+				break;
+			}
+			Offset += NumWritten;
+
+			DrainStdOut();
+		}
+
+		// Closing our end of the pipe is what lets the process see the end of its input.
+		FPlatformProcess::ClosePipe(StdInRead, StdInWrite);
+	}
+
+	// Nap between empty reads; yielding alone would spin a core for as long as git runs.
+	while (FPlatformProcess::IsProcRunning(ProcHandle))
+	{
+		if (!DrainStdOut())
+		{
+			FPlatformProcess::Sleep(UeLfsUtilsConstants::PipePollInterval);
+		}
+	}
+
+	DrainStdOut();
+
+	FPlatformProcess::GetProcReturnCode(ProcHandle, &OutReturnCode);
+	FPlatformProcess::CloseProc(ProcHandle);
+	FPlatformProcess::ClosePipe(StdOutRead, StdOutWrite);
+	FPlatformProcess::ClosePipe(StdErrRead, StdErrWrite);
+
+	const double DurationMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	TRACE_COUNTER_SET(UeLfs_GitDurationMs, DurationMs);
+
+	UE_LOG(LogSourceControl, Verbose, TEXT("[git] %s -> %d (%.1f ms, %lld bytes)"),
+		*Args, OutReturnCode, DurationMs, NumBytes);
+
+	if (StdErrBytes.Num() > 0)
+	{
+		const FUTF8ToTCHAR StdErrConverter(reinterpret_cast<const ANSICHAR*>(StdErrBytes.GetData()), StdErrBytes.Num());
+		const FString StdErrStr = FString(StdErrConverter.Length(), StdErrConverter.Get()).TrimEnd();
+		if (OutReturnCode == 0)
+		{
+			UE_LOG(LogSourceControl, Verbose, TEXT("[git] %s"), *StdErrStr);
+		}
+		else
+		{
+			UE_LOG(LogSourceControl, Warning, TEXT("[git] %s"), *StdErrStr);
+		}
+	}
+
+	return OutReturnCode == 0;
+}
+
+bool UeLfsUtils::RunGitCommandToFile(const FString& Args, const FString& Filename, int32& OutReturnCode)
+{
+	TUniquePtr<FArchive> Writer(IFileManager::Get().CreateFileWriter(*Filename));
+	if (!Writer)
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to open %s for writing!"), *Filename);
+		return false;
+	}
+
+	const bool bOk = RunGitCommandStreamed(Args,
+		[&Writer](const uint8* Data, int32 Num)
+		{
+			Writer->Serialize(const_cast<uint8*>(Data), Num);
+		},
+		OutReturnCode);
+
+	const bool bWritten = Writer->Close() && !Writer->IsError();
+	Writer.Reset();
+
+	if (!bOk || !bWritten)
+	{
+		IFileManager::Get().Delete(*Filename);
+		return false;
+	}
+
+	return true;
+}
+
+TArray<uint8> UeLfsUtils::MakeNulPathList(const TArray<FString>& Paths)
+{
+	TArray<uint8> PathList;
+	for (const FString& Path : Paths)
+	{
+		FTCHARToUTF8 Converted(*Path);
+		PathList.Append((const uint8*)Converted.Get(), Converted.Length());
+		PathList.Add(0);
+	}
+	return PathList;
+}
+
+FString UeLfsUtils::GetHeadCommit(const FString& RepoRootPath)
+{
+	FString ArgStr = FString::Printf(TEXT("-C %s rev-parse HEAD"), *RepoRootPath);
+
+	int32 ReturnCode;
+	FString StdOut;
+	FString StdErr;
+	if (UeLfsUtils::RunGitCommand(ArgStr, ReturnCode, StdOut, StdErr))
+	{
+		StdOut.TrimStartAndEndInline();
+		return StdOut;
+	}
+
+	UE_LOG(LogSourceControl, Error, TEXT("Failed to get HEAD commit! - %s"), *StdErr);
+	return TEXT("");
+}
+
+bool UeLfsUtils::GetHeadAndUpstreamCommits(const FString& RepoRootPath,
+	FString& OutHeadCommit, FString& OutUpstreamCommit)
+{
+	// Both refs in one process; without an upstream, rev-parse still prints HEAD first.
+	FString ArgStr = FString::Printf(TEXT("-C %s rev-parse HEAD @{upstream}"), *RepoRootPath);
+
+	int32 ReturnCode;
+	FString StdOut;
+	FString StdErr;
+	UeLfsUtils::RunGitCommand(ArgStr, ReturnCode, StdOut, StdErr);
+
+	TArray<FString> Lines;
+	StdOut.ParseIntoArrayLines(Lines);
+
+	OutHeadCommit = Lines.Num() > 0 ? Lines[0] : FString();
+	OutUpstreamCommit = (ReturnCode == 0 && Lines.Num() > 1) ? Lines[1] : FString();
+
+	if (OutHeadCommit.IsEmpty())
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to get HEAD commit! - %s"), *StdErr);
+		return false;
+	}
+
+	return true;
+}
+
+bool UeLfsUtils::GetChangedFiles(const FString& RepoRootPath, const FString& RevRange,
+	TArray<FString>& OutFilePaths)
+{
+	UELFS_TRACE_SCOPE(UeLfs_GetChangedFiles);
+
+	FString ArgStr = FString::Printf(TEXT("-C %s -c core.quotepath=off diff --name-only -z %s --"),
+		*RepoRootPath,
+		*RevRange);
+
+	FUeLfsRecordSplitter Splitter('\0', [&OutFilePaths, &RepoRootPath](const FString& GitFilePath)
+	{
+		OutFilePaths.Add(FPaths::Combine(RepoRootPath, GitFilePath));
+	});
+
+	int32 ReturnCode;
+	const bool bOk = RunGitCommandStreamed(ArgStr,
+		[&Splitter](const uint8* Data, int32 Num) { Splitter.Append(Data, Num); },
+		ReturnCode);
+	Splitter.Flush();
+
+	if (!bOk)
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to get files changed in %s!"), *RevRange);
+		return false;
+	}
+
+	return true;
+}
+
 FString UeLfsUtils::FindGitBinaryPath()
 {
 	FString BinPath;
@@ -146,6 +557,64 @@ bool UeLfsUtils::FindRepoRootPath(const FString& ProjectDirAbs, FString& OutRepo
 	return bFound;
 }
 
+FString UeLfsUtils::GetGitDirPath(const FString& RepoRootPath)
+{
+	const FString DotGitPath = RepoRootPath / TEXT(".git");
+	if (IFileManager::Get().DirectoryExists(*DotGitPath))
+	{
+		return DotGitPath;
+	}
+
+	// Submodules and linked worktrees have a ".git" file pointing elsewhere: "gitdir: <path>".
+	FString DotGitStr;
+	if (!FFileHelper::LoadFileToString(DotGitStr, *DotGitPath))
+	{
+		return FString();
+	}
+
+	DotGitStr.TrimStartAndEndInline();
+
+	static const FString GitDirPrefix = TEXT("gitdir:");
+	if (!DotGitStr.StartsWith(GitDirPrefix, ESearchCase::CaseSensitive))
+	{
+		return FString();
+	}
+
+	FString GitDirPath = DotGitStr.Mid(GitDirPrefix.Len()).TrimStartAndEnd();
+	if (FPaths::IsRelative(GitDirPath))
+	{
+		GitDirPath = FPaths::ConvertRelativePathToFull(RepoRootPath, GitDirPath);
+	}
+
+	FPaths::NormalizeDirectoryName(GitDirPath);
+	return GitDirPath;
+}
+
+FString UeLfsUtils::MakeDiscoveryFingerprint(const FString& ProjectDirAbs, const FString& RepoRootPath,
+	const FString& GitBinaryPath)
+{
+	FString HomeDir = FPlatformMisc::GetEnvironmentVariable(TEXT("HOME"));
+	if (HomeDir.IsEmpty())
+	{
+		HomeDir = FPlatformMisc::GetEnvironmentVariable(TEXT("USERPROFILE"));
+	}
+
+	// 'where git' may list several binaries; the first one is used.
+	TArray<FString> GitBinaryPaths;
+	GitBinaryPath.ParseIntoArrayLines(GitBinaryPaths);
+
+	IFileManager& FileManager = IFileManager::Get();
+	const FString Inputs = FString::Printf(TEXT("%s|%s|%s|%s|%s|%s"),
+		*ProjectDirAbs,
+		*FPlatformMisc::GetEnvironmentVariable(TEXT("PATH")),
+		*RepoRootPath,
+		*FileManager.GetTimeStamp(*(RepoRootPath / TEXT(".git/config"))).ToString(),
+		*FileManager.GetTimeStamp(*(HomeDir / TEXT(".gitconfig"))).ToString(),
+		GitBinaryPaths.Num() > 0 ? *FileManager.GetTimeStamp(*GitBinaryPaths[0].TrimStartAndEnd()).ToString() : TEXT(""));
+
+	return FMD5::HashAnsiString(*Inputs);
+}
+
 FString UeLfsUtils::GetGitUserName()
 {
 	FString ArgStr = FString::Printf(TEXT("config user.name"));
@@ -153,7 +622,7 @@ FString UeLfsUtils::GetGitUserName()
 	int32 ReturnCode;
 	FString StdOut;
 	FString StdErr;
-	FPlatformProcess::ExecProcess(TEXT("git"), *ArgStr, &ReturnCode, &StdOut, &StdErr);
+	UeLfsUtils::RunGitCommand(ArgStr, ReturnCode, StdOut, StdErr);
 
 	if (ReturnCode == 0)
 	{
@@ -168,7 +637,12 @@ FString UeLfsUtils::GetGitUserName()
 bool UeLfsUtils::GetLastCommitHash(const FString& FilePathAbs, const FString& RepoRootPath, FString& OutHash)
 {
 	FString GitBranchName = UeLfsUtils::GetGitBranchName(RepoRootPath);
+	return GetLastCommitHash(FilePathAbs, RepoRootPath, GitBranchName, OutHash);
+}
 
+bool UeLfsUtils::GetLastCommitHash(const FString& FilePathAbs, const FString& RepoRootPath,
+	const FString& GitBranchName, FString& OutHash)
+{
 	FString ArgStr = FString::Printf(TEXT("-C %s log %s -n 1 --pretty=format:%%H %s"),
 		*RepoRootPath,
 		*GitBranchName,
@@ -177,7 +651,7 @@ bool UeLfsUtils::GetLastCommitHash(const FString& FilePathAbs, const FString& Re
 	int32 ReturnCode;
 	FString StdOut;
 	FString StdErr;
-	FPlatformProcess::ExecProcess(TEXT("git"), *ArgStr, &ReturnCode, &StdOut, &StdErr);
+	UeLfsUtils::RunGitCommand(ArgStr, ReturnCode, StdOut, StdErr);
 
 	if (ReturnCode == 0)
 	{
@@ -189,6 +663,133 @@ bool UeLfsUtils::GetLastCommitHash(const FString& FilePathAbs, const FString& Re
 	return false;
 }
 
+bool UeLfsUtils::MakeLockItems(const TArray<FString>& FilePaths, const FString& RepoRootPath,
+	TArray<FLfsLockItem>& OutLockItems)
+{
+	UELFS_TRACE_SCOPE(UeLfs_MakeLockItems);
+
+	// Resolve the branch once for the whole batch.
+	const FString GitBranchName = UeLfsUtils::GetGitBranchName(RepoRootPath);
+
+	const int32 FirstItemIndex = OutLockItems.Num();
+	TMap<FString, int32> ItemIndices;
+	for (const FString& FilePath : FilePaths)
+	{
+		FLfsLockItem Item;
+		Item.LocalFilePath = FilePath;
+		Item.GitFilePath = FilePath;
+		FPaths::MakePathRelativeTo(Item.GitFilePath, *RepoRootPath);
+
+		ItemIndices.Add(Item.GitFilePath, OutLockItems.Num());
+		OutLockItems.Add(Item);
+	}
+
+	// One 'git log' walks the history for many files at once, listing the files of each commit
+	// (newest first); the first commit a file shows up in is its last commit. Paths still go on
+	// the command line, so they are batched to stay well below its length limit.
+	bool bResult = true;
+	int32 ItemIndex = FirstItemIndex;
+	while (ItemIndex < OutLockItems.Num())
+	{
+		FString ArgStr = FString::Printf(
+			TEXT("-C %s --literal-pathspecs log %s --pretty=format:%%x01%%H --name-only -z --"),
+			*RepoRootPath,
+			*GitBranchName);
+
+		for (; ItemIndex < OutLockItems.Num() && ArgStr.Len() < UeLfsUtilsConstants::MaxPathArgsLen; ++ItemIndex)
+		{
+			ArgStr += FString::Printf(TEXT(" \"%s\""), *OutLockItems[ItemIndex].GitFilePath);
+		}
+
+		// Records are '\x01<hash>' (with the commit's first file after a newline) and file names.
+		FString CommitHash;
+		FUeLfsRecordSplitter Splitter('\0', [&CommitHash, &ItemIndices, &OutLockItems](const FString& Record)
+		{
+			FString GitFilePath = Record;
+			while (GitFilePath.StartsWith(TEXT("\n")))
+			{
+				GitFilePath.RemoveAt(0);
+			}
+
+			if (GitFilePath.StartsWith(TEXT("\x01")))
+			{
+				int32 NewLineIndex = INDEX_NONE;
+				if (GitFilePath.FindChar(TEXT('\n'), NewLineIndex))
+				{
+					CommitHash = GitFilePath.Mid(1, NewLineIndex - 1);
+					GitFilePath = GitFilePath.Mid(NewLineIndex + 1);
+				}
+				else
+				{
+					CommitHash = GitFilePath.Mid(1);
+					GitFilePath.Reset();
+				}
+			}
+
+			const int32* Index = GitFilePath.IsEmpty() ? nullptr : ItemIndices.Find(GitFilePath);
+			if (Index != nullptr && OutLockItems[*Index].LastHash.IsEmpty())
+			{
+				OutLockItems[*Index].LastHash = CommitHash;
+			}
+		});
+
+		int32 ReturnCode;
+		const bool bOk = RunGitCommandStreamed(ArgStr,
+			[&Splitter](const uint8* Data, int32 Num) { Splitter.Append(Data, Num); },
+			ReturnCode);
+		Splitter.Flush();
+
+		if (!bOk)
+		{
+			UE_LOG(LogSourceControl, Error, TEXT("Failed to get last commit hashes! (%d)"), ReturnCode);
+			bResult = false;
+		}
+	}
+
+	return bResult;
+}
+
+TArray<FLfsLockItem> UeLfsUtils::MakeUnlockItems(const TArray<FString>& FilePaths,
+	const FString& RepoRootPath)
+{
+	TArray<FLfsLockItem> LockItems;
+	for (const FString& FilePath : FilePaths)
+	{
+		FLfsLockItem Item;
+		Item.LocalFilePath = FilePath;
+		Item.GitFilePath = FilePath;
+		FPaths::MakePathRelativeTo(Item.GitFilePath, *RepoRootPath);
+		LockItems.Add(Item);
+	}
+	return LockItems;
+}
+
+bool UeLfsUtils::ListTrackedFiles(const FString& RepoRootPath, TArray<FString>& OutFilePaths)
+{
+	UELFS_TRACE_SCOPE(UeLfs_ListTrackedFiles);
+
+	FString ArgStr = FString::Printf(TEXT("-C %s -c core.quotepath=off ls-files -z"), *RepoRootPath);
+
+	FUeLfsRecordSplitter Splitter('\0', [&OutFilePaths, &RepoRootPath](const FString& GitFilePath)
+	{
+		OutFilePaths.Add(FPaths::Combine(RepoRootPath, GitFilePath));
+	});
+
+	int32 ReturnCode;
+	const bool bOk = RunGitCommandStreamed(ArgStr,
+		[&Splitter](const uint8* Data, int32 Num) { Splitter.Append(Data, Num); },
+		ReturnCode);
+	Splitter.Flush();
+
+	if (!bOk)
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to list tracked files!"));
+		return false;
+	}
+
+	return true;
+}
+
 bool UeLfsUtils::GetAddedFiles(const TArray<FString>& FilePaths, const FString& RepoRootPath,
 	TArray<FString>& OutAddedFiles)
 {
@@ -204,7 +805,7 @@ bool UeLfsUtils::GetAddedFiles(const TArray<FString>& FilePaths, const FString&
 	int32 ReturnCode;
 	FString StdOut;
 	FString StdErr;
-	FPlatformProcess::ExecProcess(TEXT("git"), *ArgStr, &ReturnCode, &StdOut, &StdErr);
+	UeLfsUtils::RunGitCommand(ArgStr, ReturnCode, StdOut, StdErr);
 
 	if (ReturnCode == 0)
 	{
@@ -228,11 +829,257 @@ bool UeLfsUtils::GetAddedFiles(const TArray<FString>& FilePaths, const FString&
 			}
 		}
 
-		return true;
+		return true;
+	}
+
+	UE_LOG(LogSourceControl, Error, TEXT("Failed to get added files! - %s"), *StdErr);
+	return false;
+}
+
+bool UeLfsUtils::UpdateIndex(const TArray<FString>& FilePaths, const FString& RepoRootPath,
+	bool bRemove)
+{
+	UELFS_TRACE_SCOPE(UeLfs_UpdateIndex);
+
+	// --add runs the clean filters (LFS) like 'git add'; --force-remove also drops files still on disk.
+	FString ArgStr = FString::Printf(TEXT("-C %s update-index %s -z --stdin"),
+		*RepoRootPath,
+		bRemove ? TEXT("--force-remove") : TEXT("--add"));
+
+	const TArray<uint8> PathList = MakeNulPathList(ToGitFilePaths(FilePaths, RepoRootPath));
+
+	TArray<uint8> Output;
+	int32 ReturnCode;
+	const bool bOk = RunGitCommandStreamed(ArgStr,
+		[&Output](const uint8* Data, int32 Num) { Output.Append(Data, Num); },
+		ReturnCode,
+		&PathList);
+
+	if (!bOk)
+	{
+		Output.Add(0);
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to update index! - %s"),
+			UTF8_TO_TCHAR((const ANSICHAR*)Output.GetData()));
+		return false;
+	}
+
+	return true;
+}
+
+bool UeLfsUtils::RevertFiles(const TArray<FString>& FilePaths, const FString& RepoRootPath,
+	TArray<FString>& OutRevertedFiles, TArray<FString>& OutUnstagedFiles)
+{
+	UELFS_TRACE_SCOPE(UeLfs_RevertFiles);
+
+	const TArray<FString> GitFilePaths = UeLfsUtils::ToGitFilePaths(FilePaths, RepoRootPath);
+
+	// Find out which of the files exist in HEAD; one 'HEAD:<path>' object per line on stdin,
+	// so any number of files fits. ls-tree only takes paths on the command line.
+	TArray<uint8> ObjectList;
+	for (const FString& GitFilePath : GitFilePaths)
+	{
+		FTCHARToUTF8 Converted(*(TEXT("HEAD:") + GitFilePath));
+		ObjectList.Append((const uint8*)Converted.Get(), Converted.Length());
+		ObjectList.Add('\n');
+	}
+
+	FString ArgStr = FString::Printf(TEXT("-C %s cat-file --batch-check=%%(objecttype)"), *RepoRootPath);
+
+	TArray<uint8> Output;
+	int32 ReturnCode;
+	bool bOk = RunGitCommandStreamed(ArgStr,
+		[&Output](const uint8* Data, int32 Num) { Output.Append(Data, Num); },
+		ReturnCode,
+		&ObjectList);
+
+	Output.Add(0);
+	const FString StdOut = UTF8_TO_TCHAR((const ANSICHAR*)Output.GetData());
+
+	// One line per object, in order: its type, or '<object> missing'.
+	TArray<FString> Lines;
+	StdOut.ParseIntoArrayLines(Lines);
+	if (!bOk || Lines.Num() != GitFilePaths.Num())
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to list files in HEAD! (%d) - %s"), ReturnCode, *StdOut);
+		return false;
+	}
+
+	TArray<FString> RestoreFiles;
+	TArray<FString> UnstageFiles;
+	for (int32 i = 0; i < GitFilePaths.Num(); ++i)
+	{
+		if (!Lines[i].EndsWith(TEXT(" missing")))
+		{
+			RestoreFiles.Add(GitFilePaths[i]);
+			OutRevertedFiles.Add(FilePaths[i]);
+		}
+		else
+		{
+			UnstageFiles.Add(GitFilePaths[i]);
+			OutUnstagedFiles.Add(FilePaths[i]);
+		}
+	}
+
+	// Restore index and working copy from HEAD in one go; git runs the LFS smudge filter.
+	if (RestoreFiles.Num() > 0)
+	{
+		ArgStr = FString::Printf(
+			TEXT("-C %s --literal-pathspecs checkout HEAD --pathspec-from-file=- --pathspec-file-nul"),
+			*RepoRootPath);
+
+		const TArray<uint8> PathList = MakeNulPathList(RestoreFiles);
+
+		Output.Reset();
+		bOk = RunGitCommandStreamed(ArgStr,
+			[&Output](const uint8* Data, int32 Num) { Output.Append(Data, Num); },
+			ReturnCode,
+			&PathList);
+
+		if (!bOk)
+		{
+			Output.Add(0);
+			UE_LOG(LogSourceControl, Error, TEXT("Failed to revert files! (%d) - %s"),
+				ReturnCode, UTF8_TO_TCHAR((const ANSICHAR*)Output.GetData()));
+			return false;
+		}
+	}
+
+	if (UnstageFiles.Num() > 0)
+	{
+		ArgStr = FString::Printf(
+			TEXT("-C %s --literal-pathspecs rm --cached -q --ignore-unmatch --pathspec-from-file=- --pathspec-file-nul"),
+			*RepoRootPath);
+
+		const TArray<uint8> PathList = MakeNulPathList(UnstageFiles);
+
+		Output.Reset();
+		bOk = RunGitCommandStreamed(ArgStr,
+			[&Output](const uint8* Data, int32 Num) { Output.Append(Data, Num); },
+			ReturnCode,
+			&PathList);
+
+		if (!bOk)
+		{
+			Output.Add(0);
+			UE_LOG(LogSourceControl, Error, TEXT("Failed to unstage added files! (%d) - %s"),
+				ReturnCode, UTF8_TO_TCHAR((const ANSICHAR*)Output.GetData()));
+			return false;
+		}
+	}
+
+	return true;
+}
+
+bool UeLfsUtils::CommitFiles(const TArray<FString>& FilePaths, const FString& RepoRootPath,
+	const FString& Description, FString& OutCommitHash)
+{
+	UELFS_TRACE_SCOPE(UeLfs_CommitFiles);
+
+	// Checked out but unchanged files are fine; there is just nothing to commit.
+	// Tell by what differs from HEAD, not by git's messages, which may be localized.
+	TArray<FString> ChangedFiles;
+	if (!GetChangedFiles(RepoRootPath, TEXT("HEAD"), ChangedFiles))
+	{
+		return false;
+	}
+
+	const TSet<FString> ChangedFileSet(ChangedFiles);
+	const TArray<FString> FilesToCommit = FilePaths.FilterByPredicate([&ChangedFileSet](const FString& FilePath)
+	{
+		return ChangedFileSet.Contains(FilePath);
+	});
+
+	if (FilesToCommit.Num() == 0)
+	{
+		OutCommitHash.Empty();
+		return true;
+	}
+
+	// The message goes through a file, so it needs no escaping on the command line.
+	const FString MessageDir = FPaths::ConvertRelativePathToFull(FPaths::ProjectSavedDir() / TEXT("UeLfs"));
+	const FString MessageFile = FPaths::CreateTempFilename(*MessageDir, TEXT("CommitMsg-"), TEXT(".txt"));
+	if (!FFileHelper::SaveStringToFile(Description, *MessageFile, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to write commit message to %s!"), *MessageFile);
+		return false;
+	}
+
+	// Paths come from stdin; with an explicit pathspec git commits exactly these files,
+	// staging their working copy content (or removal) on the way.
+	FString ArgStr = FString::Printf(
+		TEXT("-C %s --literal-pathspecs commit -F \"%s\" --pathspec-from-file=- --pathspec-file-nul"),
+		*RepoRootPath,
+		*MessageFile);
+
+	const TArray<uint8> PathList = MakeNulPathList(ToGitFilePaths(FilesToCommit, RepoRootPath));
+
+	TArray<uint8> Output;
+	int32 ReturnCode;
+	const bool bOk = RunGitCommandStreamed(ArgStr,
+		[&Output](const uint8* Data, int32 Num) { Output.Append(Data, Num); },
+		ReturnCode,
+		&PathList);
+
+	IFileManager::Get().Delete(*MessageFile, false, false, true);
+
+	if (!bOk)
+	{
+		Output.Add(0);
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to commit files! (%d) - %s"),
+			ReturnCode, UTF8_TO_TCHAR((const ANSICHAR*)Output.GetData()));
+		return false;
+	}
+
+	OutCommitHash = GetHeadCommit(RepoRootPath);
+	return true;
+}
+
+bool UeLfsUtils::PushHead(const FString& RepoRootPath, const FString& Remote)
+{
+	UELFS_TRACE_SCOPE(UeLfs_PushHead);
+
+	FString ArgStr = FString::Printf(TEXT("-C %s push --porcelain \"%s\" HEAD"),
+		*RepoRootPath,
+		*Remote);
+
+	int32 ReturnCode;
+	FString StdOut;
+	FString StdErr;
+	if (!UeLfsUtils::RunGitCommand(ArgStr, ReturnCode, StdOut, StdErr))
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to push to %s! - %s%s"), *Remote, *StdOut, *StdErr);
+		return false;
+	}
+
+	return true;
+}
+
+bool UeLfsUtils::PullFastForward(const FString& RepoRootPath, const FString& Remote)
+{
+	UELFS_TRACE_SCOPE(UeLfs_PullFastForward);
+
+	// The branch's upstream is what the user set up to pull from; Remote is only a fallback.
+	FString ArgStr = FString::Printf(TEXT("-C %s rev-parse --abbrev-ref --symbolic-full-name @{u}"), *RepoRootPath);
+
+	int32 ReturnCode;
+	FString StdOut;
+	FString StdErr;
+	const bool bHasUpstream = UeLfsUtils::RunGitCommand(ArgStr, ReturnCode, StdOut, StdErr);
+
+	// Never merge on the user's behalf; a diverged branch needs a human.
+	ArgStr = FString::Printf(TEXT("-C %s pull --ff-only"), *RepoRootPath);
+	if (!bHasUpstream && !Remote.IsEmpty())
+	{
+		ArgStr += FString::Printf(TEXT(" \"%s\" %s"), *Remote, *GetGitBranchName(RepoRootPath));
 	}
 
-	UE_LOG(LogSourceControl, Error, TEXT("Failed to get added files! - %s"), *StdErr);
-	return false;
+	if (!UeLfsUtils::RunGitCommand(ArgStr, ReturnCode, StdOut, StdErr))
+	{
+		UE_LOG(LogSourceControl, Error, TEXT("Failed to pull! - %s%s"), *StdOut, *StdErr);
+		return false;
+	}
+
+	return true;
 }
 
 void UeLfsUtils::TickHttp(float deltaSeconds)
@@ -242,12 +1089,29 @@ void UeLfsUtils::TickHttp(float deltaSeconds)
 
 FString UeLfsUtils::GetGitBranchName(const FString& RepoRootPath)
 {
+	// Every request carries the branch, so read HEAD directly rather than spawning git.
+	const FString GitDirPath = GetGitDirPath(RepoRootPath);
+	FString HeadStr;
+	if (!GitDirPath.IsEmpty() && FFileHelper::LoadFileToString(HeadStr, *(GitDirPath / TEXT("HEAD"))))
+	{
+		HeadStr.TrimStartAndEndInline();
+
+		static const FString RefPrefix = TEXT("ref: refs/heads/");
+		if (HeadStr.StartsWith(RefPrefix, ESearchCase::CaseSensitive))
+		{
+			return HeadStr.Mid(RefPrefix.Len());
+		}
+
+		// Detached; match what "rev-parse --abbrev-ref HEAD" prints.
+		return TEXT("HEAD");
+	}
+
 	FString ArgStr = FString::Printf(TEXT("-C %s rev-parse --abbrev-ref HEAD"), *RepoRootPath);
 
 	int32 ReturnCode;
 	FString StdOut;
 	FString StdErr;
-	FPlatformProcess::ExecProcess(TEXT("git"), *ArgStr, &ReturnCode, &StdOut, &StdErr);
+	UeLfsUtils::RunGitCommand(ArgStr, ReturnCode, StdOut, StdErr);
 
 	if (ReturnCode == 0)
 	{
@@ -260,79 +1124,54 @@ FString UeLfsUtils::GetGitBranchName(const FString& RepoRootPath)
 }
 
 FUeLfsHttp::FUeLfsHttp()
-	: bLoggedIn(false)
+	: RepoResolver(nullptr)
+	, bLoggedIn(false)
+	, InFlightRequests(0)
+	, PeakInFlightRequests(0)
+	, CompletedRequests(0)
+	, FailedRequests(0)
 {
 }
 
-void FUeLfsHttp::Configure(const FUeLfsSettings& Settings)
+void FUeLfsHttp::Configure(FUeLfsRepoResolver& InRepoResolver)
 {
-	ServerUrl = Settings.GetServerUrl();
-	UserName = Settings.GetUserName();
-	RepoRootPath = Settings.GetRepoRootPath();
+	RepoResolver = &InRepoResolver;
 }
 
-bool FUeLfsHttp::ReqLogin(TArray<FString>& OutGitPaths)
+FUeLfsHttpRequestCounters FUeLfsHttp::GetRequestCounters() const
 {
-	// Set API URL.
-	FString ApiUrl = FString::Printf(TEXT("%s/unsafeLogin"), *ServerUrl);
-
-	// Build request body.
-	TSharedPtr<FJsonObject> ReqObj = MakeShareable(new FJsonObject);
-	ReqObj->SetStringField(TEXT("user"), UserName);
-
-	FString GitBranchName = UeLfsUtils::GetGitBranchName(RepoRootPath);
-	ReqObj->SetStringField(TEXT("branch"), GitBranchName);
-
-	FString ReqStr;
-	TSharedRef< TJsonWriter<> > Writer = TJsonWriterFactory<>::Create(&ReqStr);
-	FJsonSerializer::Serialize(ReqObj.ToSharedRef(), Writer);
-
-	// Build HTTP request.
-	auto HttpReq = FHttpModule::Get().CreateRequest();
-	HttpReq->SetHeader(TEXT("Content-Type"), TEXT("application/json; charset=utf-8"));
-	HttpReq->SetURL(ApiUrl);
-	HttpReq->SetVerb(TEXT("POST"));
-	HttpReq->SetContentAsString(ReqStr);
-	HttpReq->ProcessRequest();
+	FUeLfsHttpRequestCounters Counters;
+	Counters.InFlight = InFlightRequests.Load();
+	Counters.PeakInFlight = PeakInFlightRequests.Load();
+	Counters.Completed = CompletedRequests.Load();
+	Counters.Failed = FailedRequests.Load();
+	return Counters;
+}
 
-	// Synchronize the invocation of this function.
-	while (HttpReq->GetStatus() == EHttpRequestStatus::Processing)
-	{
-		FPlatformProcess::Sleep(0.2f);
-	}
+FUeLfsHttpSession FUeLfsHttp::MakeSession(const FUeLfsSettingsSnapshot& Settings, const FString& RepoRootPath) const
+{
+	const FUeLfsRepoInfoRef Repo = RepoResolver->Resolve(
+		RepoRootPath.IsEmpty() ? Settings.RepoRootPath : RepoRootPath, Settings.RepoRootPath);
+
+	FUeLfsHttpSession Session;
+	Session.ServerUrl = Repo->ServerUrl.IsEmpty() ? Settings.ServerUrl : Repo->ServerUrl;
+	Session.UserName = Settings.UserName;
+	Session.RepoRootPath = Repo->RootPath;
+	Session.BranchName = UeLfsUtils::GetGitBranchName(Repo->RootPath);
+	return Session;
+}
 
-	const FHttpResponsePtr Resp = HttpReq->GetResponse();
-	if (!Resp.IsValid())
-	{
-		UE_LOG(LogSourceControl, Error, TEXT("[/dumbLogin] No response from server!"));
-		return false;
-	}
+bool FUeLfsHttp::ReqLogin(const FUeLfsSettingsSnapshot& Settings, TArray<FString>& OutGitPaths)
+{
+	UELFS_TRACE_SCOPE(UeLfs_ReqLogin);
 
-	const FString& RespBodyStr = Resp->GetContentAsString();
-	UE_LOG(LogSourceControl, Warning,
-		TEXT("[/dumbLogin] resp: %d, content: %s"),
-		(int32)Resp->GetResponseCode(),
-		*RespBodyStr);
+	// Build request body.
+	const FUeLfsHttpSession Session = MakeSession(Settings, FString());
+	TSharedRef<FJsonObject> ReqObj = MakeRequestObject(Session);
 
-	// Parse results.
 	TSharedPtr<FJsonObject> RespObj;
-	TSharedRef< TJsonReader<> > Reader = TJsonReaderFactory<>::Create(RespBodyStr);
-	if (!FJsonSerializer::Deserialize(Reader, RespObj))
-	{
-		UE_LOG(LogSourceControl, Error,
-			TEXT("[/dumbLogin] Failed to parse response body! - %s"),
-			*RespBodyStr);
-		return false;
-	}
-
-	// Check if ok.
-	bool bOk = RespObj->GetBoolField(TEXT("ok"));
-	if (!bOk)
+	if (!PostRequest(Session, TEXT("unsafeLogin"), ReqObj, RespObj))
 	{
-		const FString& ErrorMsg = RespObj->GetStringField(TEXT("msg"));
-		UE_LOG(LogSourceControl, Error,
-			TEXT("[/dumbLogin] Error - %s"),
-			*ErrorMsg);
 		return false;
 	}
 
@@ -351,79 +1190,104 @@ bool FUeLfsHttp::ReqLogin(TArray<FString>& OutGitPaths)
 	return true;
 }
 
-bool FUeLfsHttp::ReqGetLockStates(const TArray<FString>& FilePaths,
-	TArray<FLfsLockInfo>& OutLockInfos)
+bool FUeLfsHttp::ReqGetAllLocks(const FUeLfsSettingsSnapshot& Settings, TArray<FLfsLockInfo>& OutLockInfos)
 {
-	// Set API URL.
-	FString ApiUrl = FString::Printf(TEXT("%s/getLockStates"), *ServerUrl);
-
-	// Build request body.
-	TSharedPtr<FJsonObject> ReqObj = MakeShareable(new FJsonObject);
-	ReqObj->SetStringField(TEXT("user"), UserName);
+	UELFS_TRACE_SCOPE(UeLfs_ReqGetAllLocks);
 
-	FString GitBranchName = UeLfsUtils::GetGitBranchName(RepoRootPath);
-	ReqObj->SetStringField(TEXT("branch"), GitBranchName);
+	const FUeLfsHttpSession Session = MakeSession(Settings, FString());
+	TSharedRef<FJsonObject> ReqObj = MakeRequestObject(Session);
 
-	TArray<TSharedPtr<FJsonValue>> JFiles;
-	for (const FString& FilePath : FilePaths)
+	FString RespBodyStr;
+	if (!PostRequestRaw(Session, TEXT("getAllLocks"), ReqObj, RespBodyStr))
 	{
-		FString GitFilePath = FilePath;
-		FPaths::MakePathRelativeTo(GitFilePath, *RepoRootPath);
-		JFiles.Add(MakeShareable(new FJsonValueString(GitFilePath)));
+		return false;
 	}
 
-	ReqObj->SetArrayField(TEXT("files"), JFiles);
+	// The table can be large, so read it token by token instead of building a DOM:
+	// { "ok": true, "locks": { "<user>": [ "<git path>", ... ], ... } }
+	UELFS_TRACE_SCOPE(UeLfs_JsonParse);
+	TSharedRef< TJsonReader<> > Reader = TJsonReaderFactory<>::Create(RespBodyStr);
 
-	FString ReqStr;
-	TSharedRef< TJsonWriter<> > Writer = TJsonWriterFactory<>::Create(&ReqStr);
-	FJsonSerializer::Serialize(ReqObj.ToSharedRef(), Writer);
+	bool bServerOk = false;
+	bool bInLocks = false;
+	FString LockUser;
+	EJsonNotation Notation = EJsonNotation::Null;
+	while (Reader->ReadNext(Notation))
+	{
+		switch (Notation)
+		{
+		case EJsonNotation::Boolean:
+			if (!bInLocks && Reader->GetIdentifier() == TEXT("ok"))
+			{
+				bServerOk = Reader->GetValueAsBoolean();
+			}
+			break;
 
-	// Build HTTP request.
-	auto HttpReq = FHttpModule::Get().CreateRequest();
-	HttpReq->SetHeader(TEXT("Content-Type"), TEXT("application/json; charset=utf-8"));
-	HttpReq->SetURL(ApiUrl);
-	HttpReq->SetVerb(TEXT("POST"));
-	HttpReq->SetContentAsString(ReqStr);
-	HttpReq->ProcessRequest();
+		case EJsonNotation::ObjectStart:
+			bInLocks = Reader->GetIdentifier() == TEXT("locks");
+			break;
 
-	// Synchronize the invocation of this function.
-	while (HttpReq->GetStatus() == EHttpRequestStatus::Processing)
-	{
-		FPlatformProcess::Sleep(0.2f);
+		case EJsonNotation::ObjectEnd:
+			bInLocks = false;
+			break;
+
+		case EJsonNotation::ArrayStart:
+			LockUser = bInLocks ? Reader->GetIdentifier() : FString();
+			break;
+
+		case EJsonNotation::ArrayEnd:
+			LockUser.Empty();
+			break;
+
+		case EJsonNotation::String:
+			if (bInLocks && !LockUser.IsEmpty())
+			{
+				FLfsLockInfo Ali;
+				Ali.FilePath = FPaths::Combine(Session.RepoRootPath, Reader->GetValueAsString());
+				Ali.LockUserName = LockUser;
+				OutLockInfos.Emplace(Ali);
+			}
+			break;
+
+		default:
+			break;
+		}
 	}
 
-	const FHttpResponsePtr Resp = HttpReq->GetResponse();
-	if (!Resp.IsValid())
+	if (!Reader->GetErrorMessage().IsEmpty() || !bServerOk)
 	{
-		UE_LOG(LogSourceControl, Error, TEXT("[/getLockSates] No response from server!"));
+		// Older servers lack this endpoint; callers fall back to per-file queries.
+		UE_LOG(LogSourceControl, Warning, TEXT("[/getAllLocks] Lock table not available. - %s"),
+			*Reader->GetErrorMessage());
+		OutLockInfos.Empty();
 		return false;
 	}
 
-	const FString& RespBodyStr = Resp->GetContentAsString();
-	UE_LOG(LogSourceControl, Warning,
-		TEXT("[/getLockSates] resp: %d, content: %s"),
-		(int32)Resp->GetResponseCode(),
-		*RespBodyStr);
+	return true;
+}
 
-	// Parse results.
-	TSharedPtr<FJsonObject> RespObj;
-	TSharedRef< TJsonReader<> > Reader = TJsonReaderFactory<>::Create(RespBodyStr);
-	if (!FJsonSerializer::Deserialize(Reader, RespObj))
+bool FUeLfsHttp::ReqGetLockStates(const FUeLfsSettingsSnapshot& Settings, const FString& RepoRootPath,
+	const TArray<FString>& FilePaths, TArray<FLfsLockInfo>& OutLockInfos)
+{
+	UELFS_TRACE_SCOPE(UeLfs_ReqGetLockStates);
+
+	// Build request body.
+	const FUeLfsHttpSession Session = MakeSession(Settings, RepoRootPath);
+	TSharedRef<FJsonObject> ReqObj = MakeRequestObject(Session);
+
+	TArray<TSharedPtr<FJsonValue>> JFiles;
+	for (const FString& FilePath : FilePaths)
 	{
-		UE_LOG(LogSourceControl, Error,
-			TEXT("[/getLockSates] Failed to parse response body! - %s"),
-			*RespBodyStr);
-		return false;
+		FString GitFilePath = FilePath;
+		FPaths::MakePathRelativeTo(GitFilePath, *Session.RepoRootPath);
+		JFiles.Add(MakeShareable(new FJsonValueString(GitFilePath)));
 	}
 
-	// Check if ok.
-	bool bOk = RespObj->GetBoolField(TEXT("ok"));
-	if (!bOk)
+	ReqObj->SetArrayField(TEXT("files"), JFiles);
+
+	TSharedPtr<FJsonObject> RespObj;
+	if (!PostRequest(Session, TEXT("getLockStates"), ReqObj, RespObj))
 	{
-		const FString& ErrorMsg = RespObj->GetStringField(TEXT("msg"));
-		UE_LOG(LogSourceControl, Error,
-			TEXT("[/getLockSates] Error - %s"),
-			*ErrorMsg);
 		return false;
 	}
 
@@ -432,7 +1296,7 @@ bool FUeLfsHttp::ReqGetLockStates(const TArray<FString>& FilePaths,
 	if (LockStates.Num() != FilePaths.Num())
 	{
 		UE_LOG(LogSourceControl, Error,
-			TEXT("[/getLockSates] Invalid number of lock states! - %d vs %d"),
+			TEXT("[/getLockStates] Invalid number of lock states! - %d vs %d"),
 			LockStates.Num(), FilePaths.Num());
 		return false;
 	}
@@ -455,18 +1319,14 @@ bool FUeLfsHttp::ReqGetLockStates(const TArray<FString>& FilePaths,
 	return true;
 }
 
-bool FUeLfsHttp::ReqLockFiles(const TArray<FLfsLockItem>& LockItems,
-	TArray<FLfsLockInfo>& OutLockInfos)
+bool FUeLfsHttp::ReqLockFiles(const FUeLfsSettingsSnapshot& Settings, const FString& RepoRootPath,
+	const TArray<FLfsLockItem>& LockItems, TArray<FLfsLockInfo>& OutLockInfos)
 {
-	// Set API URL.
-	FString ApiUrl = FString::Printf(TEXT("%s/lockFiles"), *ServerUrl);
+	UELFS_TRACE_SCOPE(UeLfs_ReqLockFiles);
 
 	// Build request body.
-	TSharedPtr<FJsonObject> ReqObj = MakeShareable(new FJsonObject);
-	ReqObj->SetStringField(TEXT("user"), UserName);
-
-	FString GitBranchName = UeLfsUtils::GetGitBranchName(RepoRootPath);
-	ReqObj->SetStringField(TEXT("branch"), GitBranchName);
+	const FUeLfsHttpSession Session = MakeSession(Settings, RepoRootPath);
+	TSharedRef<FJsonObject> ReqObj = MakeRequestObject(Session);
 
 	TArray<TSharedPtr<FJsonValue>> JFiles;
 	for (const FLfsLockItem& LockItem : LockItems)
@@ -480,56 +1340,9 @@ bool FUeLfsHttp::ReqLockFiles(const TArray<FLfsLockItem>& LockItems,
 
 	ReqObj->SetArrayField(TEXT("files"), JFiles);
 
-	FString ReqStr;
-	TSharedRef< TJsonWriter<> > Writer = TJsonWriterFactory<>::Create(&ReqStr);
-	FJsonSerializer::Serialize(ReqObj.ToSharedRef(), Writer);
-
-	// Build HTTP request.
-	auto HttpReq = FHttpModule::Get().CreateRequest();
-	HttpReq->SetHeader(TEXT("Content-Type"), TEXT("application/json; charset=utf-8"));
-	HttpReq->SetURL(ApiUrl);
-	HttpReq->SetVerb(TEXT("POST"));
-	HttpReq->SetContentAsString(ReqStr);
-	HttpReq->ProcessRequest();
-
-	// Synchronize the invocation of this function.
-	while (HttpReq->GetStatus() == EHttpRequestStatus::Processing)
-	{
-		FPlatformProcess::Sleep(0.2f);
-	}
-
-	const FHttpResponsePtr Resp = HttpReq->GetResponse();
-	if (!Resp.IsValid())
-	{
-		UE_LOG(LogSourceControl, Error, TEXT("[/lockFiles] No response from server!"));
-		return false;
-	}
-
-	const FString& RespBodyStr = Resp->GetContentAsString();
-	UE_LOG(LogSourceControl, Warning,
-		TEXT("[/lockFiles] resp: %d, content: %s"),
-		(int32)Resp->GetResponseCode(),
-		*RespBodyStr);
-
-	// Parse results.
 	TSharedPtr<FJsonObject> RespObj;
-	TSharedRef< TJsonReader<> > Reader = TJsonReaderFactory<>::Create(RespBodyStr);
-	if (!FJsonSerializer::Deserialize(Reader, RespObj))
-	{
-		UE_LOG(LogSourceControl, Error,
-			TEXT("[/lockFiles] Failed to parse response body! - %s"),
-			*RespBodyStr);
-		return false;
-	}
-
-	// Check if ok.
-	bool bOk = RespObj->GetBoolField(TEXT("ok"));
-	if (!bOk)
+	if (!PostRequest(Session, TEXT("lockFiles"), ReqObj, RespObj))
 	{
-		const FString& ErrorMsg = RespObj->GetStringField(TEXT("msg"));
-		UE_LOG(LogSourceControl, Error,
-			TEXT("[/lockFiles] Error - %s"),
-			*ErrorMsg);
 		return false;
 	}
 
@@ -538,7 +1351,7 @@ bool FUeLfsHttp::ReqLockFiles(const TArray<FLfsLockItem>& LockItems,
 	{
 		FLfsLockInfo Ali;
 		Ali.FilePath = LockItems[i].LocalFilePath;
-		Ali.LockUserName = UserName;
+		Ali.LockUserName = Session.UserName;
 
 		OutLockInfos.Add(Ali);
 	}
@@ -546,18 +1359,14 @@ bool FUeLfsHttp::ReqLockFiles(const TArray<FLfsLockItem>& LockItems,
 	return true;
 }
 
-bool FUeLfsHttp::ReqUnlockFiles(const TArray<FLfsLockItem>& LockItems,
-	TArray<FLfsLockInfo>& OutLockInfos)
+bool FUeLfsHttp::ReqUnlockFiles(const FUeLfsSettingsSnapshot& Settings, const FString& RepoRootPath,
+	const TArray<FLfsLockItem>& LockItems, TArray<FLfsLockInfo>& OutLockInfos)
 {
-	// Set API URL.
-	FString ApiUrl = FString::Printf(TEXT("%s/unlockFiles"), *ServerUrl);
+	UELFS_TRACE_SCOPE(UeLfs_ReqUnlockFiles);
 
 	// Build request body.
-	TSharedPtr<FJsonObject> ReqObj = MakeShareable(new FJsonObject);
-	ReqObj->SetStringField(TEXT("user"), UserName);
-
-	FString GitBranchName = UeLfsUtils::GetGitBranchName(RepoRootPath);
-	ReqObj->SetStringField(TEXT("branch"), GitBranchName);
+	const FUeLfsHttpSession Session = MakeSession(Settings, RepoRootPath);
+	TSharedRef<FJsonObject> ReqObj = MakeRequestObject(Session);
 
 	TArray<TSharedPtr<FJsonValue>> JFiles;
 	for (const FLfsLockItem& LockItem : LockItems)
@@ -567,60 +1376,9 @@ bool FUeLfsHttp::ReqUnlockFiles(const TArray<FLfsLockItem>& LockItems,
 
 	ReqObj->SetArrayField(TEXT("files"), JFiles);
 
-	FString ReqStr;
-	TSharedRef< TJsonWriter<> > Writer = TJsonWriterFactory<>::Create(&ReqStr);
-	FJsonSerializer::Serialize(ReqObj.ToSharedRef(), Writer);
-
-	// Build HTTP request.
-	auto HttpReq = FHttpModule::Get().CreateRequest();
-	HttpReq->SetHeader(TEXT("Content-Type"), TEXT("application/json; charset=utf-8"));
-	HttpReq->SetURL(ApiUrl);
-	HttpReq->SetVerb(TEXT("POST"));
-	HttpReq->SetContentAsString(ReqStr);
-	HttpReq->ProcessRequest();
-
-	// Synchronize the invocation of this function.
-	double LastTime = FPlatformTime::Seconds();
-	while (HttpReq->GetStatus() == EHttpRequestStatus::Processing)
-	{
-		double AppTime = FPlatformTime::Seconds();
-		FHttpModule::Get().GetHttpManager().Tick(AppTime - LastTime);
-		LastTime = AppTime;
-		FPlatformProcess::Sleep(0.2f);
-	}
-
-	const FHttpResponsePtr Resp = HttpReq->GetResponse();
-	if (!Resp.IsValid())
-	{
-		UE_LOG(LogSourceControl, Error, TEXT("[/unlockFiles] No response from server!"));
-		return false;
-	}
-
-	const FString& RespBodyStr = Resp->GetContentAsString();
-	UE_LOG(LogSourceControl, Warning,
-		TEXT("[/unlockFiles] resp: %d, content: %s"),
-		(int32)Resp->GetResponseCode(),
-		*RespBodyStr);
-
-	// Parse results.
 	TSharedPtr<FJsonObject> RespObj;
-	TSharedRef< TJsonReader<> > Reader = TJsonReaderFactory<>::Create(RespBodyStr);
-	if (!FJsonSerializer::Deserialize(Reader, RespObj))
-	{
-		UE_LOG(LogSourceControl, Error,
-			TEXT("[/unlockFiles] Failed to parse response body! - %s"),
-			*RespBodyStr);
-		return false;
-	}
-
-	// Check if ok.
-	bool bOk = RespObj->GetBoolField(TEXT("ok"));
-	if (!bOk)
+	if (!PostRequest(Session, TEXT("unlockFiles"), ReqObj, RespObj))
 	{
-		const FString& ErrorMsg = RespObj->GetStringField(TEXT("msg"));
-		UE_LOG(LogSourceControl, Error,
-			TEXT("[/unlockFiles] Error - %s"),
-			*ErrorMsg);
 		return false;
 	}
 
@@ -636,71 +1394,210 @@ bool FUeLfsHttp::ReqUnlockFiles(const TArray<FLfsLockItem>& LockItems,
 	return true;
 }
 
-bool FUeLfsHttp::ReqUnlockAll()
+bool FUeLfsHttp::ReqUnlockAll(const FUeLfsSettingsSnapshot& Settings)
 {
-	// Set API URL.
-	FString ApiUrl = FString::Printf(TEXT("%s/unlockAll"), *ServerUrl);
+	UELFS_TRACE_SCOPE(UeLfs_ReqUnlockAll);
 
 	// Build request body.
-	TSharedPtr<FJsonObject> ReqObj = MakeShareable(new FJsonObject);
-	ReqObj->SetStringField(TEXT("user"), UserName);
+	const FUeLfsHttpSession Session = MakeSession(Settings, FString());
+	TSharedRef<FJsonObject> ReqObj = MakeRequestObject(Session);
 
-	FString GitBranchName = UeLfsUtils::GetGitBranchName(RepoRootPath);
-	ReqObj->SetStringField(TEXT("branch"), GitBranchName);
+	TSharedPtr<FJsonObject> RespObj;
+	return PostRequest(Session, TEXT("unlockAll"), ReqObj, RespObj);
+}
+
+TSharedRef<FJsonObject> FUeLfsHttp::MakeRequestObject(const FUeLfsHttpSession& Session) const
+{
+	TSharedRef<FJsonObject> ReqObj = MakeShared<FJsonObject>();
+	ReqObj->SetStringField(TEXT("user"), Session.UserName);
+	ReqObj->SetStringField(TEXT("branch"), Session.BranchName);
+
+	return ReqObj;
+}
+
+bool FUeLfsHttp::PostRequestRaw(const FUeLfsHttpSession& Session, const TCHAR* Endpoint, const TSharedRef<FJsonObject>& ReqObj,
+	FString& OutRespBody)
+{
+	UELFS_TRACE_SCOPE(UeLfs_HttpPost);
+
+	// Set API URL.
+	FString ApiUrl = FString::Printf(TEXT("%s/%s"), *Session.ServerUrl, Endpoint);
 
 	FString ReqStr;
-	TSharedRef< TJsonWriter<> > Writer = TJsonWriterFactory<>::Create(&ReqStr);
-	FJsonSerializer::Serialize(ReqObj.ToSharedRef(), Writer);
+	{
+		UELFS_TRACE_SCOPE(UeLfs_JsonSerialize);
+		TSharedRef< TJsonWriter<> > Writer = TJsonWriterFactory<>::Create(&ReqStr);
+		FJsonSerializer::Serialize(ReqObj, Writer);
+	}
+
+	const FUeLfsEndpointPolicy Policy = GetEndpointPolicy(Endpoint);
+
+	// One key for every attempt, so the server can tell a retry from a new request.
+	const FString IdempotencyKey = Policy.bNeedsIdempotencyKey
+		? FGuid::NewGuid().ToString(EGuidFormats::DigitsWithHyphens)
+		: FString();
+
+	for (int32 Attempt = 1; ; ++Attempt)
+	{
+		const FHttpResponsePtr Resp = SendRequest(ApiUrl, ReqStr, IdempotencyKey, Policy.Timeout, Endpoint);
+		const bool bRetryable = !Resp.IsValid() || IsRetryableResponseCode(Resp->GetResponseCode());
+
+		if (bRetryable && Attempt < UeLfsUtilsConstants::HttpMaxAttempts)
+		{
+			const float Delay = GetRetryDelay(Attempt);
+			UE_LOG(LogSourceControl, Warning,
+				TEXT("[/%s] attempt %d of %d failed (%d), retrying in %.2f s ..."),
+				Endpoint,
+				Attempt,
+				UeLfsUtilsConstants::HttpMaxAttempts,
+				Resp.IsValid() ? (int32)Resp->GetResponseCode() : 0,
+				Delay);
+			FPlatformProcess::Sleep(Delay);
+			continue;
+		}
+
+		if (!Resp.IsValid())
+		{
+			UE_LOG(LogSourceControl, Error, TEXT("[/%s] No response from server!"), Endpoint);
+			++FailedRequests;
+			return false;
+		}
+
+		++CompletedRequests;
+		OutRespBody = Resp->GetContentAsString();
+		return true;
+	}
+}
+
+FHttpResponsePtr FUeLfsHttp::SendRequest(const FString& ApiUrl, const FString& ReqStr,
+	const FString& IdempotencyKey, float Timeout, const TCHAR* Endpoint)
+{
+	TRACE_COUNTER_INCREMENT(UeLfs_HttpRequests);
 
 	// Build HTTP request.
 	auto HttpReq = FHttpModule::Get().CreateRequest();
 	HttpReq->SetHeader(TEXT("Content-Type"), TEXT("application/json; charset=utf-8"));
+	HttpReq->SetHeader(TEXT("Connection"), TEXT("keep-alive"));
+	if (!IdempotencyKey.IsEmpty())
+	{
+		HttpReq->SetHeader(TEXT("Idempotency-Key"), IdempotencyKey);
+	}
 	HttpReq->SetURL(ApiUrl);
 	HttpReq->SetVerb(TEXT("POST"));
 	HttpReq->SetContentAsString(ReqStr);
+
+	// Wake up as soon as the request completes, instead of polling its status.
+	TSharedRef<FUeLfsHttpDoneEvent, ESPMode::ThreadSafe> Done = MakeShared<FUeLfsHttpDoneEvent, ESPMode::ThreadSafe>();
+	HttpReq->OnProcessRequestComplete().BindLambda(
+		[Done](FHttpRequestPtr, FHttpResponsePtr, bool)
+		{
+			Done->Event->Trigger();
+		});
+
+	TRACE_COUNTER_ADD(UeLfs_HttpBytesSent, HttpReq->GetContentLength());
+
+	const int32 InFlight = ++InFlightRequests;
+	int32 PeakInFlight = PeakInFlightRequests.Load();
+	while (PeakInFlight < InFlight && !PeakInFlightRequests.CompareExchange(PeakInFlight, InFlight))
+	{
+	}
+	TRACE_COUNTER_SET(UeLfs_HttpInFlight, InFlight);
+
+	const double StartTime = FPlatformTime::Seconds();
+	const double Deadline = StartTime + Timeout;
 	HttpReq->ProcessRequest();
 
 	// Synchronize the invocation of this function.
-	double LastTime = FPlatformTime::Seconds();
-	while (HttpReq->GetStatus() == EHttpRequestStatus::Processing)
+	// The http manager only needs manual ticking when the game thread is blocked on us.
+	bool bTimedOut = false;
+	{
+		UELFS_TRACE_SCOPE(UeLfs_HttpWait);
+
+		const bool bTickHttp = IsInGameThread();
+		double LastTime = StartTime;
+		while (!Done->Event->Wait(UeLfsUtilsConstants::HttpTickIntervalMs))
+		{
+			double AppTime = FPlatformTime::Seconds();
+			if (AppTime >= Deadline)
+			{
+				bTimedOut = true;
+				break;
+			}
+
+			if (bTickHttp)
+			{
+				FHttpModule::Get().GetHttpManager().Tick(AppTime - LastTime);
+				LastTime = AppTime;
+			}
+		}
+	}
+
+	TRACE_COUNTER_SET(UeLfs_HttpInFlight, --InFlightRequests);
+
+	if (bTimedOut)
 	{
-		double AppTime = FPlatformTime::Seconds();
-		FHttpModule::Get().GetHttpManager().Tick(AppTime - LastTime);
-		LastTime = AppTime;
-		FPlatformProcess::Sleep(0.2f);
+		// The completion delegate still fires later; it keeps the event alive by itself.
+		HttpReq->CancelRequest();
+		UE_LOG(LogSourceControl, Warning, TEXT("[/%s] timed out after %.1f s!"), Endpoint, Timeout);
+		return nullptr;
 	}
 
+	const double LatencyMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+	TRACE_COUNTER_SET(UeLfs_HttpLatencyMs, LatencyMs);
+
 	const FHttpResponsePtr Resp = HttpReq->GetResponse();
 	if (!Resp.IsValid())
 	{
-		UE_LOG(LogSourceControl, Error, TEXT("[/unlockAll] No response from server!"));
-		return false;
+		return nullptr;
 	}
 
-	const FString& RespBodyStr = Resp->GetContentAsString();
-	UE_LOG(LogSourceControl, Warning,
-		TEXT("[/unlockAll] resp: %d, content: %s"),
+	TRACE_COUNTER_ADD(UeLfs_HttpBytesReceived, Resp->GetContent().Num());
+	TRACE_COUNTER_SET(UeLfs_HttpStatus, Resp->GetResponseCode());
+
+	UE_LOG(LogSourceControl, Log,
+		TEXT("[/%s] resp: %d (%.1f ms), %d bytes, %d in flight"),
+		Endpoint,
 		(int32)Resp->GetResponseCode(),
-		*RespBodyStr);
+		LatencyMs,
+		Resp->GetContent().Num(),
+		InFlight);
 
-	// Parse results.
-	TSharedPtr<FJsonObject> RespObj;
-	TSharedRef< TJsonReader<> > Reader = TJsonReaderFactory<>::Create(RespBodyStr);
-	if (!FJsonSerializer::Deserialize(Reader, RespObj))
+	return Resp;
+}
+
+bool FUeLfsHttp::PostRequest(const FUeLfsHttpSession& Session, const TCHAR* Endpoint, const TSharedRef<FJsonObject>& ReqObj,
+	TSharedPtr<FJsonObject>& OutRespObj)
+{
+	FString RespBodyStr;
+	if (!PostRequestRaw(Session, Endpoint, ReqObj, RespBodyStr))
 	{
-		UE_LOG(LogSourceControl, Error,
-			TEXT("[/unlockAll] Failed to parse response body! - %s"),
-			*RespBodyStr);
 		return false;
 	}
 
+	UE_LOG(LogSourceControl, Warning, TEXT("[/%s] content: %s"), Endpoint, *RespBodyStr);
+
+	// Parse results.
+	{
+		UELFS_TRACE_SCOPE(UeLfs_JsonParse);
+		TSharedRef< TJsonReader<> > Reader = TJsonReaderFactory<>::Create(RespBodyStr);
+		if (!FJsonSerializer::Deserialize(Reader, OutRespObj) || !OutRespObj.IsValid())
+		{
+			UE_LOG(LogSourceControl, Error,
+				TEXT("[/%s] Failed to parse response body! - %s"),
+				Endpoint,
+				*RespBodyStr);
+			return false;
+		}
+	}
+
 	// Check if ok.
-	bool bOk = RespObj->GetBoolField(TEXT("ok"));
+	bool bOk = OutRespObj->GetBoolField(TEXT("ok"));
 	if (!bOk)
 	{
-		const FString& ErrorMsg = RespObj->GetStringField(TEXT("msg"));
+		const FString& ErrorMsg = OutRespObj->GetStringField(TEXT("msg"));
 		UE_LOG(LogSourceControl, Error,
-			TEXT("[/unlockAll] Error - %s"),
+			TEXT("[/%s] Error - %s"),
+			Endpoint,
 			*ErrorMsg);
 		return false;
 	}
@@ -5,6 +5,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "HAL/ThreadSafeBool.h"
+#include "Interfaces/IHttpResponse.h"
+#include "Templates/Atomic.h"
 
 struct FLfsLockInfo
 {
@@ -19,13 +22,64 @@ struct FLfsLockItem
 	FString LastHash;
 };
 
-class FUeLfsSettings;
+struct FUeLfsSettingsSnapshot;
+
+/**
+ * Splits a byte stream into records ending with a delimiter ('\n' or '\0'),
+ * across chunk boundaries. Only the current partial record is buffered.
+ */
+class FUeLfsRecordSplitter
+{
+public:
+	FUeLfsRecordSplitter(ANSICHAR InDelimiter, TFunction<void(const FString&)> InOnRecord);
+
+	// Feed the next chunk of the stream.
+	void Append(const uint8* Data, int32 Num);
+
+	// Emit the last record if the stream did not end with a delimiter.
+	void Flush();
+
+private:
+	void EmitRecord(const uint8* Data, int32 Num);
+
+private:
+	ANSICHAR Delimiter;
+	TFunction<void(const FString&)> OnRecord;
+	TArray<uint8> Pending;
+};
 
 namespace UeLfsUtils
 {
-	// Check for git-supported file names.
-	bool CheckFilename(const FString& FileName);
-	bool CheckFilenames(const TArray<FString>& FileNames);
+	// Does the file name have wildcards ('...', '*' or '?')? Those are not supported by UeLfs.
+	bool HasWildcards(const FString& FileName);
+
+	// Run git with the arguments and wait for it to exit.
+	bool RunGitCommand(const FString& Args, int32& OutReturnCode, FString& OutStdOut, FString& OutStdErr);
+
+	// Run git and stream stdout in byte chunks to the callback, in constant memory.
+	// If given, StdIn is written to the process (e.g. paths for --stdin or --pathspec-from-file=-).
+	// Stderr is read from a pipe of its own and only logged.
+	bool RunGitCommandStreamed(const FString& Args, TFunctionRef<void(const uint8*, int32)> OnStdOut,
+		int32& OutReturnCode, const TArray<uint8>* StdIn = nullptr);
+
+	// Run git and write stdout straight into a file. (binary safe)
+	bool RunGitCommandToFile(const FString& Args, const FString& Filename, int32& OutReturnCode);
+
+	// Encode paths as NUL-terminated UTF-8, for git's -z / --pathspec-file-nul input.
+	TArray<uint8> MakeNulPathList(const TArray<FString>& Paths);
+
+	// Get the commit hash HEAD points at.
+	FString GetHeadCommit(const FString& RepoRootPath);
+
+	// Get the commits HEAD and its upstream branch point at, with one git invocation.
+	// OutUpstreamCommit is left empty if the branch has no upstream.
+	bool GetHeadAndUpstreamCommits(const FString& RepoRootPath,
+		FString& OutHeadCommit, FString& OutUpstreamCommit);
+
+	// Get abs paths of the files changed in a revision range ('A..B', 'A...B'),
+	// or between a revision and the working tree ('HEAD').
+	bool GetChangedFiles(const FString& RepoRootPath, const FString& RevRange,
+		TArray<FString>& OutFilePaths);
 
 	// Convert abs file paths to git file paths.
 	TArray<FString> ToGitFilePaths(const TArray<FString>& AbsFilePaths, const FString& RepoRootPath);
@@ -36,46 +90,148 @@ namespace UeLfsUtils
 	// Find git repository root path.
 	bool FindRepoRootPath(const FString& ProjectDirAbs, FString& OutRepoRootPath);
 
+	// Get where git keeps the repository of a working tree root, following the "gitdir:" file
+	// of submodules and linked worktrees. Empty if the directory is not a repository root.
+	FString GetGitDirPath(const FString& RepoRootPath);
+
 	// Get git user name.
 	FString GetGitUserName();
 
+	// Fingerprint of everything discovery depends on (project dir, PATH, git configs, binary).
+	// Only stats files, so it is cheap enough to check on every launch.
+	FString MakeDiscoveryFingerprint(const FString& ProjectDirAbs, const FString& RepoRootPath,
+		const FString& GitBinaryPath);
+
 	// Get last commit has for the file.
 	bool GetLastCommitHash(const FString& FilePathAbs, const FString& RepoRootPath, FString& OutHash);
+	bool GetLastCommitHash(const FString& FilePathAbs, const FString& RepoRootPath,
+		const FString& GitBranchName, FString& OutHash);
+
+	// Build lock items (git path and last commit hash) for the files, with one 'git log' for many files.
+	// Touches no provider state, so it can run on any thread.
+	bool MakeLockItems(const TArray<FString>& FilePaths, const FString& RepoRootPath,
+		TArray<FLfsLockItem>& OutLockItems);
+
+	// Build lock items carrying only the paths, which is all unlocking (or locking files to delete) needs.
+	TArray<FLfsLockItem> MakeUnlockItems(const TArray<FString>& FilePaths, const FString& RepoRootPath);
+
+	// List abs paths of all files tracked in the index.
+	bool ListTrackedFiles(const FString& RepoRootPath, TArray<FString>& OutFilePaths);
 
 	// Gather newly added files among the files.
 	bool GetAddedFiles(const TArray<FString>& FilePaths, const FString& RepoRootPath,
 		TArray<FString>& OutAddedFiles);
 
+	// Add files to the index, or remove them from it, with one 'git update-index' per batch.
+	// Paths are passed on stdin, so the batch size is not limited by the command line.
+	bool UpdateIndex(const TArray<FString>& FilePaths, const FString& RepoRootPath, bool bRemove);
+
+	// Restore files from HEAD (including LFS smudge). Paths go through stdin, so any number of files fits.
+	// Files missing from HEAD are only dropped from the index; their local copies are kept.
+	bool RevertFiles(const TArray<FString>& FilePaths, const FString& RepoRootPath,
+		TArray<FString>& OutRevertedFiles, TArray<FString>& OutUnstagedFiles);
+
+	// Commit the current content of the files (added, modified or deleted) with one git invocation.
+	// Succeeds without a commit if none of the files changed; OutCommitHash is then left empty.
+	bool CommitFiles(const TArray<FString>& FilePaths, const FString& RepoRootPath,
+		const FString& Description, FString& OutCommitHash);
+
+	// Push the current branch to the remote (name, URL or local path).
+	bool PushHead(const FString& RepoRootPath, const FString& Remote);
+
+	// Fast-forward the current branch from its upstream, or, without one, from the branch of the same name on Remote.
+	bool PullFastForward(const FString& RepoRootPath, const FString& Remote);
+
 	// Manually tick http module.
 	void TickHttp(float deltaSeconds);
 
-	// Get git branch name.
+	// Get git branch name. (read from HEAD in the git directory; git is only run if that fails)
 	FString GetGitBranchName(const FString& RepoRootPath);
 
 }; // namespace UeLfsUtils
 
+/**
+ * Everything one request needs, captured when the request starts.
+ * Concurrent requests never share mutable state.
+ */
+struct FUeLfsHttpSession
+{
+	FString ServerUrl;
+	FString UserName;
+	FString RepoRootPath;
+	FString BranchName;
+};
+
+/**
+ * Counters of the requests made through a FUeLfsHttp. These count requests only;
+ * connections belong to the http module, which exposes nothing about them.
+ */
+struct FUeLfsHttpRequestCounters
+{
+	int32 InFlight = 0;
+	int32 PeakInFlight = 0;
+	int32 Completed = 0;
+	int32 Failed = 0;
+};
+
+/**
+ * Client of the UeLfs server. Safe to use from any number of threads at once;
+ * each request runs on its own session. Requests ask for keep-alive, but whether a
+ * connection is reused is up to the http module.
+ */
 class FUeLfsHttp
 {
 public:
 	FUeLfsHttp();
 
-	void Configure(const FUeLfsSettings& Settings);
+	// Bind the repositories; every request reads the branch and lock server of the repository it is about.
+	void Configure(class FUeLfsRepoResolver& InRepoResolver);
 	bool IsLoggedIn() const { return bLoggedIn; }
 
+	// Get the request counters.
+	FUeLfsHttpRequestCounters GetRequestCounters() const;
+
 public:
 
-	bool ReqLogin(TArray<FString>& OutGitPaths);
-	bool ReqGetLockStates(const TArray<FString>& FilePaths, TArray<FLfsLockInfo>& OutLockInfos);
-	bool ReqLockFiles(const TArray<FLfsLockItem>& LockReqObjs,
-		TArray<FLfsLockInfo>& OutLockInfos);
-	bool ReqUnlockFiles(const TArray<FLfsLockItem>& LockReqObjs,
-		TArray<FLfsLockInfo>& OutLockInfos);
-	bool ReqUnlockAll();
+	// Every request runs with the settings snapshot of the command making it.
+	bool ReqLogin(const FUeLfsSettingsSnapshot& Settings, TArray<FString>& OutGitPaths);
+	bool ReqGetAllLocks(const FUeLfsSettingsSnapshot& Settings, TArray<FLfsLockInfo>& OutLockInfos);
+	bool ReqGetLockStates(const FUeLfsSettingsSnapshot& Settings, const FString& RepoRootPath,
+		const TArray<FString>& FilePaths, TArray<FLfsLockInfo>& OutLockInfos);
+	bool ReqLockFiles(const FUeLfsSettingsSnapshot& Settings, const FString& RepoRootPath,
+		const TArray<FLfsLockItem>& LockReqObjs, TArray<FLfsLockInfo>& OutLockInfos);
+	bool ReqUnlockFiles(const FUeLfsSettingsSnapshot& Settings, const FString& RepoRootPath,
+		const TArray<FLfsLockItem>& LockReqObjs, TArray<FLfsLockInfo>& OutLockInfos);
+	bool ReqUnlockAll(const FUeLfsSettingsSnapshot& Settings);
 
 private:
-	FString ServerUrl;
-	FString UserName;
-	FString RepoRootPath;
+	// Capture the settings, and the branch and lock server of the repository, for one request.
+	// An empty root is the configured repository.
+	FUeLfsHttpSession MakeSession(const FUeLfsSettingsSnapshot& Settings, const FString& RepoRootPath) const;
+
+	// Build a request object carrying the user and branch.
+	TSharedRef<class FJsonObject> MakeRequestObject(const FUeLfsHttpSession& Session) const;
+
+	// Post a JSON request to the endpoint and wait for the response body.
+	// Timed out, unanswered and 408/429/5xx requests are retried with backoff.
+	bool PostRequestRaw(const FUeLfsHttpSession& Session, const TCHAR* Endpoint, const TSharedRef<class FJsonObject>& ReqObj,
+		FString& OutRespBody);
+
+	// Send one attempt of a request; null if it timed out or got no response.
+	FHttpResponsePtr SendRequest(const FString& ApiUrl, const FString& ReqStr,
+		const FString& IdempotencyKey, float Timeout, const TCHAR* Endpoint);
+
+	// Post a JSON request to the endpoint and wait for a successful ('ok') response.
+	bool PostRequest(const FUeLfsHttpSession& Session, const TCHAR* Endpoint, const TSharedRef<class FJsonObject>& ReqObj,
+		TSharedPtr<class FJsonObject>& OutRespObj);
+
+private:
+	class FUeLfsRepoResolver* RepoResolver;
+
+	FThreadSafeBool bLoggedIn;
 
-	bool bLoggedIn;
+	TAtomic<int32> InFlightRequests;
+	TAtomic<int32> PeakInFlightRequests;
+	TAtomic<int32> CompletedRequests;
+	TAtomic<int32> FailedRequests;
 };
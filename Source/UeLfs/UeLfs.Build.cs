@@ -23,7 +23,9 @@ public class UeLfs : ModuleRules
 				"JsonUtilities",
 				"UnrealEd",
 				"Projects",
-				"PackagesDialog",
+				"TraceLog",
+				"ContentBrowser",
+				"AssetRegistry",
             }
         );
     }